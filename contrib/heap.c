@@ -0,0 +1,234 @@
+/*
+ * Copyright(C) 2016 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ * 
+ * This file is part of MyLib.
+ *
+ * MyLib is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ * 
+ * MyLib is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with MyLib; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include <mylib/util.h>
+#include <mylib/heap.h>
+
+/**
+ * @brief Heap node.
+ */
+struct hnode
+{
+	void *obj;  /**< Underlying object. */
+	double key; /**< Priority key.      */
+};
+
+/**
+ * @brief Heap.
+ */
+struct heap
+{
+	int size;            /**< Current heap size. */
+	int maxsize;         /**< Maximum heap size. */
+	struct hnode *nodes; /**< Heap nodes.        */
+};
+
+/*====================================================================*
+ * HEAP NODE                                                          *
+ *====================================================================*/
+
+/**
+ * @brief Exchanges two heap nodes.
+ *
+ * @param h Target heap.
+ * @param i Index of first node.
+ * @param j Index of second node.
+ */
+static inline void hnode_exch(struct heap *h, int i, int j)
+{
+	struct hnode tmp;
+
+	tmp = h->nodes[i];
+	h->nodes[i] = h->nodes[j];
+	h->nodes[j] = tmp;
+}
+
+/*====================================================================*
+ * HEAP                                                               *
+ *====================================================================*/
+
+/**
+ * @brief Creates a heap.
+ *
+ * @param maxsize Initial maximum heap size.
+ *
+ * @returns A heap.
+ */
+struct heap *heap_create(int maxsize)
+{
+	struct heap *h;
+
+	/* Sanity check. */
+	assert(maxsize >= 0);
+
+	h = smalloc(sizeof(struct heap));
+
+	/* Initialize heap. */
+	h->size = 0;
+	h->maxsize = (maxsize > 0) ? maxsize : 1;
+	h->nodes = smalloc(h->maxsize*sizeof(struct hnode));
+
+	return (h);
+}
+
+/**
+ * @brief Destroys a heap.
+ *
+ * @param h Target heap.
+ */
+void heap_destroy(struct heap *h)
+{
+	/* Sanity check. */
+	assert(h != NULL);
+
+	free(h->nodes);
+	free(h);
+}
+
+/**
+ * @brief Returns the size of a heap.
+ *
+ * @param h Target heap.
+ *
+ * @returns The current size of the target heap.
+ */
+int heap_size(const struct heap *h)
+{
+	/* Sanity check. */
+	assert(h != NULL);
+
+	return (h->size);
+}
+
+/**
+ * @brief Asserts if a heap is empty.
+ *
+ * @param h Target heap.
+ *
+ * @returns True if the target heap is empty and false otherwise.
+ */
+bool heap_empty(const struct heap *h)
+{
+	return (heap_size(h) == 0);
+}
+
+/**
+ * @brief Returns the smallest key in a heap.
+ *
+ * @param h Target heap.
+ *
+ * @returns The key of the object at the top of the target heap.
+ */
+double heap_min(const struct heap *h)
+{
+	/* Sanity check. */
+	assert(h != NULL);
+	assert(h->size != 0);
+
+	return (h->nodes[0].key);
+}
+
+/**
+ * @brief Returns the object with the smallest key in a heap.
+ *
+ * @param h Target heap.
+ *
+ * @returns The object at the top of the target heap.
+ */
+void *heap_top(const struct heap *h)
+{
+	/* Sanity check. */
+	assert(h != NULL);
+	assert(h->size != 0);
+
+	return (h->nodes[0].obj);
+}
+
+/**
+ * @brief Inserts an object in a heap.
+ *
+ * @param h   Target heap.
+ * @param obj Target object.
+ * @param key Priority key.
+ */
+void heap_insert(struct heap *h, void *obj, double key)
+{
+	/* Sanity check. */
+	assert(h != NULL);
+	assert(obj != NULL);
+
+	/* Grow heap. */
+	if (h->size == h->maxsize)
+	{
+		h->maxsize *= 2;
+		h->nodes = realloc(h->nodes, h->maxsize*sizeof(struct hnode));
+		assert(h->nodes != NULL);
+	}
+
+	h->nodes[h->size].obj = obj;
+	h->nodes[h->size].key = key;
+
+	/* Sift up. */
+	for (int i = h->size++; i > 0; i = (i - 1)/2)
+	{
+		if (h->nodes[(i - 1)/2].key <= h->nodes[i].key)
+			break;
+
+		hnode_exch(h, i, (i - 1)/2);
+	}
+}
+
+/**
+ * @brief Removes the object with the smallest key from a heap.
+ *
+ * @param h Target heap.
+ *
+ * @returns The object at the top of the heap.
+ */
+void *heap_remove(struct heap *h)
+{
+	void *obj; /* Object at the top of the heap. */
+
+	/* Sanity check. */
+	assert(h != NULL);
+	assert(h->size != 0);
+
+	obj = h->nodes[0].obj;
+	h->nodes[0] = h->nodes[--h->size];
+
+	/* Sift down. */
+	for (int i = 0, j = 1; j < h->size; i = j, j = 2*i + 1)
+	{
+		if ((j + 1 < h->size) && (h->nodes[j + 1].key < h->nodes[j].key))
+			j++;
+
+		if (h->nodes[i].key <= h->nodes[j].key)
+			break;
+
+		hnode_exch(h, i, j);
+	}
+
+	return (obj);
+}
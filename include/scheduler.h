@@ -32,13 +32,24 @@
 
 	/**
 	 * @brief Loop scheduling strategy.
+	 *
+	 * @details Calling init() again before end() starts a new instance
+	 * of the loop that reuses the current plan. init() returns the
+	 * number of tasks that it planned, or planned again, so that the
+	 * planning cost can be charged.
+	 *
+	 * sched() assigns a chunk of tasks to a thread, and inserts the
+	 * thread in the running queue keyed by the processing time of the
+	 * chunk, which is the sum of the values returned by thread_assign()
+	 * for its tasks, and not by the workload of the chunk. Slower threads
+	 * therefore come back later to the simulation engine.
 	 */
 	struct scheduler
 	{
-		bool pinthreads;                                /**< Pin threads? */
-		void (*init)(const_workload_tt, array_tt, int); /**< Initialize.  */
-		int (*sched)(dqueue_tt, thread_tt);             /**< Schedule.    */
-		void (*end)(void);                              /**< End.         */
+		bool pinthreads;                               /**< Pin threads? */
+		int (*init)(const_workload_tt, array_tt, int); /**< Initialize.  */
+		int (*sched)(dqueue_tt, thread_tt);            /**< Schedule.    */
+		void (*end)(void);                             /**< End.         */
 	};
 
 	/**
@@ -46,17 +57,132 @@
 	 */
 	/**@{*/
 	extern const struct scheduler *sched_guided;
+	extern const struct scheduler *sched_wguided;
 	extern const struct scheduler *sched_dynamic;
+	extern const struct scheduler *sched_lpt;
 	extern const struct scheduler *sched_hss;
 	extern const struct scheduler *sched_kass;
 	extern const struct scheduler *sched_binlpt;
+	extern const struct scheduler *sched_hbinlpt;
 	extern const struct scheduler *sched_srr;
 	extern const struct scheduler *sched_static;
+	extern const struct scheduler *sched_ccp;
+	extern const struct scheduler *sched_hybrid;
+	extern const struct scheduler *sched_oracle;
+	extern const struct scheduler *sched_auto;
+	/**@}*/
+
+	/**
+	 * @brief Tail scheduling schemes for hybrid scheduling.
+	 */
+	enum hybrid_tail
+	{
+		HYBRID_TAIL_DYNAMIC, /**< Dynamic scheduling. */
+		HYBRID_TAIL_GUIDED   /**< Guided scheduling.  */
+	};
+
+	/**
+	 * @name Hybrid Scheduling Parameters
+	 */
+	/**@{*/
+	extern double hybrid_fraction;       /**< Static fraction. */
+	extern enum hybrid_tail hybrid_tail; /**< Tail scheme.     */
+	/**@}*/
+
+	/**
+	 * @name Overhead Model Parameters
+	 */
+	/**@{*/
+	extern double overhead_dispatch;   /**< Cost per dispatch.            */
+	extern double overhead_contention; /**< Cost per concurrent dispatch. */
+	extern double overhead_plan;       /**< Planning cost per task.       */
+	/**@}*/
+
+	/**
+	 * @brief Thread wake-up models.
+	 */
+	enum wakeup_model
+	{
+		WAKEUP_LINEAR, /**< One after the other. */
+		WAKEUP_RANDOM  /**< At random delays.    */
+	};
+
+	/**
+	 * @name Fork-Join Model Parameters
+	 */
+	/**@{*/
+	extern enum wakeup_model forkjoin_wakeup; /**< Wake-up model.               */
+	extern double forkjoin_skew;              /**< Mean delay between wake-ups. */
+	extern double forkjoin_barrier;           /**< Cost per barrier level.      */
+	/**@}*/
+
+	/**
+	 * @brief Time-slicing policies.
+	 */
+	enum timeslice_policy
+	{
+		TIMESLICE_RR, /**< Round-robin.                */
+		TIMESLICE_CFS /**< Least run time first (CFS). */
+	};
+
+	/**
+	 * @name Time-Slicing Parameters
+	 */
+	/**@{*/
+	extern int timeslice_ncpus;                    /**< Number of hardware threads. */
+	extern enum timeslice_policy timeslice_policy; /**< Time-slicing policy.        */
+	extern double timeslice_quantum;               /**< Time slice.                 */
+	extern double timeslice_switch;                /**< Context switch cost.        */
+	/**@}*/
+
+	/**
+	 * @brief Redistribution policies for absent threads.
+	 */
+	enum elastic_policy
+	{
+		ELASTIC_STEAL, /**< Any idle thread takes over chunks.     */
+		ELASTIC_ADOPT  /**< The first idle thread takes over all. */
+	};
+
+	/**
+	 * @name Elasticity Parameters
+	 */
+	/**@{*/
+	extern enum elastic_policy elastic_policy; /**< Redistribution policy.        */
+	extern double elastic_cost;                /**< Cost per redistributed task. */
+	/**@}*/
+
+	/**
+	 * @name BinLPT Scheduling Parameters
+	 */
+	/**@{*/
+	extern bool binlpt_incremental; /**< Repair plans?           */
+	extern double binlpt_tolerance; /**< Tolerated quality loss. */
+	/**@}*/
+
+	/**
+	 * @name Hierarchy Parameters
+	 */
+	/**@{*/
+	extern int hierarchy_nnodes;     /**< Number of nodes.          */
+	extern double hierarchy_latency; /**< Inter-node dispatch cost. */
+	/**@}*/
+
+	/**
+	 * @name Auto Scheduling Parameters
+	 */
+	/**@{*/
+	extern const char *auto_rules; /**< Decision rules file. */
 	/**@}*/
 
 	/* Fordward definitions. */
 	extern int nchunks;
 
-	extern void simshed(const_workload_tt, array_tt, const struct scheduler*, int);
+	extern double simshed(const_workload_tt, array_tt, const struct scheduler*, int);
+	extern double simshed_step(const_workload_tt, array_tt, const struct scheduler*, int, bool);
+	extern void simshed_end(const struct scheduler*);
+	extern double simshed_hierarchical(const_workload_tt, array_tt, const struct scheduler*, const struct scheduler*, int, int);
+	extern double oracle_makespan(const_workload_tt, array_tt);
+	extern int binlpt_repair(const int *, int);
 
 #endif /* SCHEDULER_H_ */
@@ -22,6 +22,10 @@
 #ifndef THREAD_H_
 #define THREAD_H_
 
+	#include <stdbool.h>
+
+	#include "workload.h"
+
 	/**
 	 * @brief Opaque pointer to a thread.
 	 */
@@ -36,12 +40,118 @@
 	 * @name Operations on Thread
 	 */
 	/**@{*/
-	extern thread_tt thread_create(int);
+	extern thread_tt thread_create(double);
 	extern void thread_destroy(thread_tt);
 	extern int thread_gettid(const_thread_tt);
 	extern double thread_wtotal(const_thread_tt);
-	extern int thread_assign(thread_tt, int);
-	extern int thread_capacity(const_thread_tt);
+	extern int thread_assign(thread_tt, const_workload_tt, int);
+	extern double thread_capacity(const_thread_tt);
+	extern double thread_rate(const_thread_tt);
+	extern void thread_reset(thread_tt);
+	extern double thread_wremote(const_thread_tt);
+	extern void thread_set_topology(thread_tt, int, int, int);
+	extern int thread_socket(const_thread_tt);
+	extern int thread_node(const_thread_tt);
+	extern int thread_cache(const_thread_tt);
+	extern void thread_set_type(thread_tt, int);
+	extern int thread_type(const_thread_tt);
+	extern void thread_set_speed(thread_tt, double, double);
+	extern double thread_speed(thread_tt, double, double *);
+	extern double thread_finish(thread_tt, double, double);
+	extern int thread_ntasks(const_thread_tt);
+	extern int thread_nhits(const_thread_tt);
+	extern int thread_nreuses(const_thread_tt);
+	extern void thread_migrate(thread_tt, thread_tt);
+	extern double thread_bytes(const_thread_tt);
+	extern void thread_set_offset(thread_tt, double);
+	extern double thread_offset(const_thread_tt);
+	extern void thread_set_core(thread_tt, int);
+	extern int thread_core(const_thread_tt);
+	extern void thread_set_cpu(thread_tt, int);
+	extern int thread_cpu(const_thread_tt);
+	extern void thread_set_window(thread_tt, double, double);
+	extern double thread_arrival(const_thread_tt);
+	extern double thread_departure(const_thread_tt);
+	extern void thread_set_proxy(thread_tt, thread_tt);
+	extern void thread_charge(thread_tt, double, double, double);
+	extern void thread_set_record(thread_tt, int *);
+	extern int thread_nrecorded(const_thread_tt);
+	/**@}*/
+
+	/**
+	 * @name NUMA Parameters
+	 */
+	/**@{*/
+	extern int numa_nnodes;    /**< Number of NUMA nodes.     */
+	extern double numa_remote; /**< Remote access multiplier. */
+	/**@}*/
+
+	/**
+	 * @name Task Class Parameters
+	 */
+	/**@{*/
+	extern int speed_nclasses;   /**< Number of task classes.      */
+	extern int speed_ntypes;     /**< Number of core types.        */
+	extern double *speed_matrix; /**< Relative cost, class by type. */
+	extern double speed_factor(int, int);
+	/**@}*/
+
+	/**
+	 * @name Bandwidth Parameters
+	 */
+	/**@{*/
+	extern double bandwidth_limit;     /**< Memory bandwidth.         */
+	extern double bandwidth_intensity; /**< Default memory intensity. */
+	/**@}*/
+
+	/**
+	 * @name SMT Parameters
+	 */
+	/**@{*/
+	extern int smt_ncores;   /**< Number of physical cores.       */
+	extern double smt_corun; /**< Relative speed when co-running. */
+	/**@}*/
+
+	/**
+	 * @name Locality Parameters
+	 */
+	/**@{*/
+	extern int locality_footprint; /**< Memory footprint of a task.  */
+	extern int locality_cache;     /**< Size of the cache of a core. */
+	extern double locality_warm;   /**< Relative cost of a hit.      */
+	extern double locality_reuse;  /**< Relative cost of a reuse.    */
+	extern bool locality_persist;  /**< Keep caches across loops?    */
+	extern bool locality_pin;      /**< Pin threads to cores?        */
+	/**@}*/
+
+	/**
+	 * @brief Jitter models.
+	 */
+	enum jitter_model
+	{
+		JITTER_NONE,     /**< No jitter.                   */
+		JITTER_PERIODIC, /**< Periodic interrupts.         */
+		JITTER_RANDOM    /**< Randomly spaced stalls.      */
+	};
+
+	/**
+	 * @name Jitter Parameters
+	 */
+	/**@{*/
+	extern enum jitter_model jitter_model; /**< Jitter model.              */
+	extern double jitter_interval;         /**< Mean time between stalls.  */
+	extern double jitter_length;           /**< Length of a stall.         */
+	/**@}*/
+
+	/**
+	 * @name Background Load Parameters
+	 */
+	/**@{*/
+	extern double background_on;    /**< Mean busy period.             */
+	extern double background_off;   /**< Mean idle period.             */
+	extern double background_share; /**< Relative speed when sharing. */
+	extern void background_set(int, double, double);
+	extern void background_reset(void);
 	/**@}*/
 
 #endif /* THREAD_H_ */
@@ -69,6 +69,17 @@
 	extern workload_tt workload_read(FILE *);
 	extern void workload_set_task(workload_tt, int, int);
 	extern int *workload_cummulative_sum(const_workload_tt);
+	extern void workload_partition(const_workload_tt, int, int, int *, int *);
+	extern int workload_actual(const_workload_tt, int);
+	extern void workload_set_actual(workload_tt, int, int);
+	extern void workload_perturb(workload_tt, double);
+	extern void workload_drift(workload_tt, double);
+	extern workload_tt workload_reveal(const_workload_tt);
+	extern workload_tt workload_subset(const_workload_tt, const int *, int, int);
+	extern void workload_copy(workload_tt, const_workload_tt);
+	extern int workload_home(const_workload_tt, int, int);
+	extern int workload_class(const_workload_tt, int);
+	extern double workload_intensity(const_workload_tt, int, double);
 	/**@}*/
 
 #endif /* WORKLOAD_H_ */
@@ -24,6 +24,7 @@
 #include <math.h>
 #include <time.h>
 #include <stdio.h>
+#include <string.h>
 
 #include <mylib/util.h>
 
@@ -35,8 +36,12 @@
  */
 struct workload
 {
-	int ntasks; /**< Number of tasks. */
-	int *tasks; /**< Tasks.           */
+	int ntasks;  /**< Number of tasks.                  */
+	int *tasks;  /**< Tasks (estimated cost).           */
+	int *actual; /**< Actual cost (NULL if exact).      */
+	int *home;   /**< Home nodes (NULL if default).     */
+	int *tclass; /**< Task classes (NULL if none).      */
+	double *mem; /**< Memory intensity (NULL if none).  */
 };
 
 /**
@@ -88,6 +93,10 @@ struct workload *workload_create(histogram_tt h, int skewness, int ntasks)
 	w = smalloc(sizeof(struct workload));
 	w->ntasks = ntasks;
 	w->tasks = smalloc(ntasks*sizeof(int));
+	w->actual = NULL;
+	w->home = NULL;
+	w->tclass = NULL;
+	w->mem = NULL;
 
 	/* Create workload. */
 	k = 0;
@@ -128,10 +137,59 @@ void workload_destroy(struct workload *w)
 	/* Sanity check. */
 	assert(w != NULL);
 
+	if (w->mem != NULL)
+		free(w->mem);
+	if (w->tclass != NULL)
+		free(w->tclass);
+	if (w->home != NULL)
+		free(w->home);
+	if (w->actual != NULL)
+		free(w->actual);
 	free(w->tasks);
 	free(w);
 }
 
+/**
+ * @brief Swaps the attributes of two tasks.
+ *
+ * @param w Target workload.
+ * @param i First task.
+ * @param j Second task.
+ */
+static void workload_swap_attributes(struct workload *w, int i, int j)
+{
+	int tmp;
+	double dtmp;
+
+	if (w->actual != NULL)
+	{
+		tmp = w->actual[i];
+		w->actual[i] = w->actual[j];
+		w->actual[j] = tmp;
+	}
+
+	if (w->home != NULL)
+	{
+		tmp = w->home[i];
+		w->home[i] = w->home[j];
+		w->home[j] = tmp;
+	}
+
+	if (w->tclass != NULL)
+	{
+		tmp = w->tclass[i];
+		w->tclass[i] = w->tclass[j];
+		w->tclass[j] = tmp;
+	}
+
+	if (w->mem != NULL)
+	{
+		dtmp = w->mem[i];
+		w->mem[i] = w->mem[j];
+		w->mem[j] = dtmp;
+	}
+}
+
 /**
  * @brief Sorts tasks in ascending order.
  *
@@ -153,6 +211,7 @@ static void workload_ascending(struct workload *w)
 				tmp = w->tasks[j];
 				w->tasks[j] = w->tasks[i];
 				w->tasks[i] = tmp;
+				workload_swap_attributes(w, i, j);
 			}
 		}
 	}
@@ -179,6 +238,7 @@ static void workload_descending(struct workload *w)
 				tmp = w->tasks[j];
 				w->tasks[j] = w->tasks[i];
 				w->tasks[i] = tmp;
+				workload_swap_attributes(w, i, j);
 			}
 		}
 	}
@@ -205,6 +265,7 @@ static void workload_shuffle(struct workload *w)
 		tmp = w->tasks[i];
 		w->tasks[i] = w->tasks[j];
 		w->tasks[j] = tmp;
+		workload_swap_attributes(w, i, j);
 	}
 }
 
@@ -243,9 +304,44 @@ void workload_sort(struct workload *w, enum workload_sorting sorting)
 			break;
 	}
 }
+
+/**
+ * @brief Merge sorts a task sorting map.
+ *
+ * @param tasks Tasks.
+ * @param map   Target sorting map.
+ * @param tmp   Scratch buffer.
+ * @param n     Size of the target sorting map.
+ */
+static void workload_mergesort(const int *tasks, int *map, int *tmp, int n)
+{
+	int i, j, k;
+
+	if (n < 2)
+		return;
+
+	workload_mergesort(tasks, map, tmp, n/2);
+	workload_mergesort(tasks, map + n/2, tmp, n - n/2);
+
+	/* Merge. */
+	for (i = 0, j = n/2, k = 0; k < n; k++)
+	{
+		if ((j == n) || ((i < n/2) && (tasks[map[i]] <= tasks[map[j]])))
+			tmp[k] = map[i++];
+		else
+			tmp[k] = map[j++];
+	}
+
+	for (k = 0; k < n; k++)
+		map[k] = tmp[k];
+}
+
 /**
  * @brief Computes the task sorting map of a workload.
  * 
+ * @details Tasks are sorted by increasing cost. The sort is stable, so
+ * tasks of equal cost keep their index order.
+ *
  * @param w Target workload
  * 
  * @returns Sorting map.
@@ -253,6 +349,7 @@ void workload_sort(struct workload *w, enum workload_sorting sorting)
 int *workload_sortmap(const struct workload *w)
 {
 	int *map;
+	int *tmp;
 
 	/* Sanity check. */
 	assert(w != NULL);
@@ -262,21 +359,9 @@ int *workload_sortmap(const struct workload *w)
 		map[i] = i;
 
 	/* Sort. */
-	for (int i = 0; i < w->ntasks - 1; i++)
-	{
-		for (int j = i + 1; j < w->ntasks; j++)
-		{
-			/* Swap. */
-			if (w->tasks[map[j]] < w->tasks[map[i]])
-			{
-				int tmp;
-				
-				tmp = map[j];
-				map[j] = map[i];
-				map[i] = tmp;
-			}
-		}
-	}
+	tmp = smalloc(w->ntasks*sizeof(int));
+	workload_mergesort(w->tasks, map, tmp, w->ntasks);
+	free(tmp);
 	
 	return (map);
 } 
@@ -296,12 +381,34 @@ void workload_write(FILE *outfile, const struct workload *w)
 	/* Write workload to file. */
 	fprintf(outfile, "%d\n", w->ntasks);
 	for (int i = 0; i < w->ntasks; i++)
-		fprintf(outfile, "%d\n", w->tasks[i]);
+	{
+		if (w->mem != NULL)
+		{
+			fprintf(outfile, "%d %d %d %d %lf\n", w->tasks[i], workload_actual(w, i),
+				(w->home != NULL) ? w->home[i] : -1, workload_class(w, i), w->mem[i]);
+		}
+		else if (w->tclass != NULL)
+		{
+			fprintf(outfile, "%d %d %d %d\n", w->tasks[i], workload_actual(w, i),
+				(w->home != NULL) ? w->home[i] : -1, w->tclass[i]);
+		}
+		else if (w->home != NULL)
+			fprintf(outfile, "%d %d %d\n", w->tasks[i], workload_actual(w, i), w->home[i]);
+		else if (w->actual != NULL)
+			fprintf(outfile, "%d %d\n", w->tasks[i], w->actual[i]);
+		else
+			fprintf(outfile, "%d\n", w->tasks[i]);
+	}
 }
 
 /**
  * @brief Reads a workload from a file.
  *
+ * @details Each task is given either by its cost or by its estimated
+ * cost followed by its actual cost and, optionally, its home NUMA node
+ * (-1 for default), its task class and its memory intensity, in bytes
+ * per unit of work (-1 for default).
+ *
  * @param infile Input file.
  *
  * @returns A workload.
@@ -309,6 +416,7 @@ void workload_write(FILE *outfile, const struct workload *w)
 struct workload *workload_read(FILE *infile)
 {
 	int ntasks;         /**< Number of tasks. */
+	char line[64];      /**< Current line.    */
 	struct workload *w; /**< Workload.        */
 
 	/* Sanity check. */
@@ -318,11 +426,77 @@ struct workload *workload_read(FILE *infile)
 
 	w = smalloc(sizeof(struct workload));
 	w->tasks = smalloc(ntasks*sizeof(int));
+	w->actual = NULL;
+	w->home = NULL;
+	w->tclass = NULL;
+	w->mem = NULL;
 	w->ntasks = ntasks;
 
-	/* Write workload to file. */
+	/* Read workload from file. */
 	for (int i = 0; i < ntasks; i++)
-		assert(fscanf(infile, "%d\n", &w->tasks[i]) == 1);
+	{
+		int actual;
+		int home = -1;
+		int tclass = 0;
+		double mem = -1.0;
+
+		if (fgets(line, sizeof(line), infile) == NULL)
+			error("bad workload file");
+
+		switch (sscanf(line, "%d %d %d %d %lf", &w->tasks[i], &actual, &home, &tclass, &mem))
+		{
+			case 1:
+				actual = w->tasks[i];
+				break;
+
+			case 2:
+			case 3:
+			case 4:
+			case 5:
+				break;
+
+			default:
+				error("bad workload file");
+		}
+
+		if ((w->home == NULL) && (home >= 0))
+		{
+			w->home = smalloc(ntasks*sizeof(int));
+			for (int j = 0; j < i; j++)
+				w->home[j] = -1;
+		}
+		if (w->home != NULL)
+			w->home[i] = home;
+
+		if (tclass < 0)
+			error("bad workload file");
+		if ((w->tclass == NULL) && (tclass > 0))
+		{
+			w->tclass = smalloc(ntasks*sizeof(int));
+			for (int j = 0; j < ntasks; j++)
+				w->tclass[j] = 0;
+		}
+		if (w->tclass != NULL)
+			w->tclass[i] = tclass;
+
+		if ((w->mem == NULL) && (mem >= 0.0))
+		{
+			w->mem = smalloc(ntasks*sizeof(double));
+			for (int j = 0; j < i; j++)
+				w->mem[j] = -1.0;
+		}
+		if (w->mem != NULL)
+			w->mem[i] = mem;
+
+		if ((w->actual == NULL) && (actual != w->tasks[i]))
+		{
+			w->actual = smalloc(ntasks*sizeof(int));
+			for (int j = 0; j < i; j++)
+				w->actual[j] = w->tasks[j];
+		}
+		if (w->actual != NULL)
+			w->actual[i] = actual;
+	}
 
 	return (w);
 }
@@ -404,3 +578,387 @@ int *workload_cummulative_sum(const struct workload *w)
 	return (sum);
 
 }
+
+/**
+ * @brief Splits the first tasks of a workload into contiguous blocks.
+ *
+ * @details Blocks carry about the same load. Block j spans tasks
+ * start[j] to end[j], inclusive. Blocks that get no tasks are left
+ * untouched.
+ *
+ * @param w       Target workload.
+ * @param ntasks  Number of tasks to split.
+ * @param nblocks Number of blocks.
+ * @param start   First task of blocks (output).
+ * @param end     Last task of blocks (output).
+ */
+void workload_partition(const struct workload *w, int ntasks, int nblocks, int *start, int *end)
+{
+	int size;        /* Size of current block. */
+	int wsize;       /* Load to split.         */
+	int chunkweight; /* Target block weight.   */
+
+	/* Sanity check. */
+	assert(w != NULL);
+	assert((ntasks >= 0) && (ntasks <= w->ntasks));
+	assert(nblocks > 0);
+	assert(start != NULL);
+	assert(end != NULL);
+
+	if (ntasks == 0)
+		return;
+
+	wsize = 0;
+	for (int i = 0; i < ntasks; i++)
+		wsize += w->tasks[i];
+	chunkweight = wsize/nblocks;
+
+	/* Create blocks. */
+	size = 0;
+	start[0] = 0;
+	for (int i = 0, j = 0; i < ntasks; i++)
+	{
+		if ((i == (ntasks - 1)) || (j == (nblocks - 1)))
+		{
+			end[j] = ntasks - 1;
+			break;
+		}
+
+		/* Next block. */
+		if (size >= chunkweight)
+		{
+			end[j++] = i - 1;
+
+			size = 0;
+			start[j] = i;
+		}
+
+		size += w->tasks[i];
+	}
+}
+
+/**
+ * @brief Returns the actual cost of the ith task in a workload.
+ *
+ * @details Strategies plan with the estimated costs returned by
+ * workload_task(), whereas the engine charges actual costs.
+ *
+ * @param w   Target workload.
+ * @param idx Index of target task.
+ *
+ * @returns The actual cost of the ith task in the target workload.
+ */
+int workload_actual(const struct workload *w, int idx)
+{
+	/* Sanity check. */
+	assert(w != NULL);
+	assert((idx >= 0) && (idx < w->ntasks));
+
+	return ((w->actual != NULL) ? w->actual[idx] : w->tasks[idx]);
+}
+
+/**
+ * @brief Adjusts the actual cost of the ith task in a workload.
+ *
+ * @param w    Target workload.
+ * @param idx  Index of target task.
+ * @param load New actual cost.
+ */
+void workload_set_actual(struct workload *w, int idx, int load)
+{
+	/* Sanity check. */
+	assert(w != NULL);
+	assert((idx >= 0) && (idx < w->ntasks));
+	assert(load > 0);
+
+	if (w->actual == NULL)
+	{
+		/* Nothing to do. */
+		if (load == w->tasks[idx])
+			return;
+
+		w->actual = smalloc(w->ntasks*sizeof(int));
+		for (int i = 0; i < w->ntasks; i++)
+			w->actual[i] = w->tasks[i];
+	}
+
+	w->actual[idx] = load;
+}
+
+/**
+ * @brief Draws a unit-mean log-normal factor.
+ *
+ * @param sigma Standard deviation of the underlying Gaussian.
+ *
+ * @returns A log-normal random factor.
+ */
+static double workload_lognormal(double sigma)
+{
+	double u1, u2; /* Uniform variables. */
+	double z;      /* Gaussian variable. */
+
+	/* Box-Muller transform. */
+	u1 = (rand() + 1.0)/(RAND_MAX + 2.0);
+	u2 = (rand() + 1.0)/(RAND_MAX + 2.0);
+	z = sqrt(-2.0*log(u1))*cos(2*M_PI*u2);
+
+	return (exp(sigma*z - sigma*sigma/2));
+}
+
+/**
+ * @brief Applies multiplicative noise to the actual costs of a workload.
+ *
+ * @details Each actual cost is scaled by a log-normal factor with unit
+ * mean, so estimates are unbiased but off by about @p sigma.
+ *
+ * @param w     Target workload.
+ * @param sigma Standard deviation of the underlying Gaussian.
+ */
+void workload_perturb(struct workload *w, double sigma)
+{
+	/* Sanity check. */
+	assert(w != NULL);
+	assert(sigma >= 0.0);
+
+	if (sigma == 0.0)
+		return;
+
+	for (int i = 0; i < w->ntasks; i++)
+	{
+		int load;
+
+		load = floor(workload_actual(w, i)*workload_lognormal(sigma) + 0.5);
+		workload_set_actual(w, i, (load < 1) ? 1 : load);
+	}
+}
+
+/**
+ * @brief Drifts the costs of a workload.
+ *
+ * @details Both the estimated and the actual cost of each task are
+ * scaled by the same unit-mean log-normal factor, which models the
+ * slow change of iteration costs between time steps.
+ *
+ * @param w     Target workload.
+ * @param sigma Standard deviation of the underlying Gaussian.
+ */
+void workload_drift(struct workload *w, double sigma)
+{
+	/* Sanity check. */
+	assert(w != NULL);
+	assert(sigma >= 0.0);
+
+	if (sigma == 0.0)
+		return;
+
+	for (int i = 0; i < w->ntasks; i++)
+	{
+		int load;   /* Estimated cost. */
+		int actual; /* Actual cost.    */
+		double f;   /* Drift factor.   */
+
+		f = workload_lognormal(sigma);
+		actual = floor(workload_actual(w, i)*f + 0.5);
+		load = floor(w->tasks[i]*f + 0.5);
+		w->tasks[i] = (load < 1) ? 1 : load;
+		workload_set_actual(w, i, (actual < 1) ? 1 : actual);
+	}
+}
+
+/**
+ * @brief Reveals the actual costs of a workload.
+ *
+ * @param w Target workload.
+ *
+ * @returns A copy of the target workload whose estimated costs are
+ * the actual costs.
+ */
+struct workload *workload_reveal(const struct workload *w)
+{
+	struct workload *r;
+
+	/* Sanity check. */
+	assert(w != NULL);
+
+	r = smalloc(sizeof(struct workload));
+	r->ntasks = w->ntasks;
+	r->tasks = smalloc(w->ntasks*sizeof(int));
+	r->actual = NULL;
+	r->home = NULL;
+	r->tclass = NULL;
+	r->mem = NULL;
+
+	for (int i = 0; i < w->ntasks; i++)
+		r->tasks[i] = workload_actual(w, i);
+
+	return (r);
+}
+
+/**
+ * @brief Extracts some tasks of a workload.
+ *
+ * @details Tasks keep their costs, class, memory intensity and home
+ * NUMA node in the original workload.
+ *
+ * @param w      Target workload.
+ * @param tasks  Indexes of target tasks.
+ * @param n      Number of target tasks.
+ * @param nnodes Number of NUMA nodes.
+ *
+ * @returns A workload made of the target tasks, in the given order.
+ */
+struct workload *workload_subset(const struct workload *w, const int *tasks, int n, int nnodes)
+{
+	struct workload *s;
+
+	/* Sanity check. */
+	assert(w != NULL);
+	assert(tasks != NULL);
+	assert(n > 0);
+	assert(nnodes > 0);
+
+	s = smalloc(sizeof(struct workload));
+	s->ntasks = n;
+	s->tasks = smalloc(n*sizeof(int));
+	s->actual = (w->actual != NULL) ? smalloc(n*sizeof(int)) : NULL;
+	s->home = smalloc(n*sizeof(int));
+	s->tclass = (w->tclass != NULL) ? smalloc(n*sizeof(int)) : NULL;
+	s->mem = (w->mem != NULL) ? smalloc(n*sizeof(double)) : NULL;
+
+	for (int k = 0; k < n; k++)
+	{
+		int i = tasks[k];
+
+		assert((i >= 0) && (i < w->ntasks));
+
+		s->tasks[k] = w->tasks[i];
+		s->home[k] = workload_home(w, i, nnodes);
+		if (s->actual != NULL)
+			s->actual[k] = w->actual[i];
+		if (s->tclass != NULL)
+			s->tclass[k] = w->tclass[i];
+		if (s->mem != NULL)
+			s->mem[k] = w->mem[i];
+	}
+
+	return (s);
+}
+
+/**
+ * @brief Copies a workload onto another one of the same size.
+ *
+ * @details Tasks take the costs, class, memory intensity and home
+ * NUMA node of the tasks in the source workload.
+ *
+ * @param w   Target workload.
+ * @param src Source workload.
+ */
+void workload_copy(struct workload *w, const struct workload *src)
+{
+	/* Sanity check. */
+	assert(w != NULL);
+	assert(src != NULL);
+	assert(w->ntasks == src->ntasks);
+
+	memcpy(w->tasks, src->tasks, w->ntasks*sizeof(int));
+
+	if (w->actual != NULL)
+		free(w->actual);
+	w->actual = NULL;
+	if (src->actual != NULL)
+	{
+		w->actual = smalloc(w->ntasks*sizeof(int));
+		memcpy(w->actual, src->actual, w->ntasks*sizeof(int));
+	}
+
+	if (w->home != NULL)
+		free(w->home);
+	w->home = NULL;
+	if (src->home != NULL)
+	{
+		w->home = smalloc(w->ntasks*sizeof(int));
+		memcpy(w->home, src->home, w->ntasks*sizeof(int));
+	}
+
+	if (w->tclass != NULL)
+		free(w->tclass);
+	w->tclass = NULL;
+	if (src->tclass != NULL)
+	{
+		w->tclass = smalloc(w->ntasks*sizeof(int));
+		memcpy(w->tclass, src->tclass, w->ntasks*sizeof(int));
+	}
+
+	if (w->mem != NULL)
+		free(w->mem);
+	w->mem = NULL;
+	if (src->mem != NULL)
+	{
+		w->mem = smalloc(w->ntasks*sizeof(double));
+		memcpy(w->mem, src->mem, w->ntasks*sizeof(double));
+	}
+}
+
+/**
+ * @brief Returns the home NUMA node of the ith task in a workload.
+ *
+ * @details Tasks without an explicit home node follow a block
+ * distribution of the iteration space across NUMA nodes.
+ *
+ * @param w      Target workload.
+ * @param idx    Index of target task.
+ * @param nnodes Number of NUMA nodes.
+ *
+ * @returns The home NUMA node of the ith task in the target workload.
+ */
+int workload_home(const struct workload *w, int idx, int nnodes)
+{
+	/* Sanity check. */
+	assert(w != NULL);
+	assert((idx >= 0) && (idx < w->ntasks));
+	assert(nnodes > 0);
+
+	if ((w->home != NULL) && (w->home[idx] >= 0))
+		return (w->home[idx]%nnodes);
+
+	return (((long) idx)*nnodes/w->ntasks);
+}
+
+/**
+ * @brief Returns the class of the ith task in a workload.
+ *
+ * @param w   Target workload.
+ * @param idx Index of target task.
+ *
+ * @returns The class of the ith task in the target workload.
+ */
+int workload_class(const struct workload *w, int idx)
+{
+	/* Sanity check. */
+	assert(w != NULL);
+	assert((idx >= 0) && (idx < w->ntasks));
+
+	return ((w->tclass != NULL) ? w->tclass[idx] : 0);
+}
+
+/**
+ * @brief Returns the memory intensity of the ith task in a workload.
+ *
+ * @param w    Target workload.
+ * @param idx  Index of target task.
+ * @param dflt Default memory intensity.
+ *
+ * @returns The number of bytes that the ith task in the target
+ * workload moves per unit of work, or @p dflt if not given.
+ */
+double workload_intensity(const struct workload *w, int idx, double dflt)
+{
+	/* Sanity check. */
+	assert(w != NULL);
+	assert((idx >= 0) && (idx < w->ntasks));
+
+	if ((w->mem == NULL) || (w->mem[idx] < 0.0))
+		return (dflt);
+
+	return (w->mem[idx]);
+}
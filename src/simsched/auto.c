@@ -0,0 +1,420 @@
+/*
+ * Copyright(C) 2016 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ * 
+ * This file is part of Scheduler.
+ *
+ * Scheduler is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ * 
+ * Scheduler is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Scheduler; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include <mylib/util.h>
+#include <mylib/dqueue.h>
+#include <mylib/queue.h>
+
+#include <scheduler.h>
+
+/**
+ * @brief Maximum number of decision rules.
+ */
+#define AUTO_MAX_RULES 64
+
+/**
+ * @brief Decision rules file.
+ */
+const char *auto_rules = NULL;
+
+/**
+ * @brief Workload and platform features.
+ */
+enum auto_feature
+{
+	AUTO_ANY,      /**< Always matches.                 */
+	AUTO_COV,      /**< Workload CoV.                   */
+	AUTO_SKEWNESS, /**< Workload skewness.              */
+	AUTO_AUTOCORR, /**< Workload lag-1 autocorrelation. */
+	AUTO_MAXMEAN,  /**< Workload max/mean ratio.        */
+	AUTO_TCOV,     /**< Thread capacity CoV.            */
+	AUTO_NFEATURES /**< Number of features.             */
+};
+
+/**
+ * @brief Feature names.
+ */
+static const char *auto_feature_names[AUTO_NFEATURES] = {
+	"*", "cov", "skewness", "autocorr", "maxmean", "tcov"
+};
+
+/**
+ * @brief Decision rule.
+ */
+struct auto_rule
+{
+	enum auto_feature feature; /**< Feature.                      */
+	char op[3];                /**< Comparison operator.          */
+	double threshold;          /**< Threshold.                    */
+	char strategy[16];         /**< Loop scheduling strategy.     */
+	int chunksize;             /**< Tasks per chunk (0 for none). */
+};
+
+/**
+ * @brief Default decision rules.
+ */
+static const char *auto_default_rules[] = {
+	"tcov     >  0.1  kass",
+	"cov      <  0.1  static",
+	"maxmean  >  10.0 binlpt",
+	"skewness >  1.0  binlpt",
+	"autocorr >  0.5  kass",
+	"*        *  0.0  guided",
+	NULL
+};
+
+/**
+ * @brief Auto scheduler data.
+ */
+static struct
+{
+	const struct scheduler *strategy; /**< Selected strategy.          */
+	int chunksize;                    /**< Chunk parameter of strategy. */
+} scheddata = { NULL, 0 };
+
+/**
+ * @brief Looks up a loop scheduling strategy.
+ *
+ * @param name Name of the strategy.
+ *
+ * @returns The target loop scheduling strategy.
+ */
+static const struct scheduler *auto_lookup(const char *name)
+{
+	if (!strcmp(name, "static"))
+		return (sched_static);
+	if (!strcmp(name, "ccp"))
+		return (sched_ccp);
+	if (!strcmp(name, "dynamic"))
+		return (sched_dynamic);
+	if (!strcmp(name, "lpt"))
+		return (sched_lpt);
+	if (!strcmp(name, "guided"))
+		return (sched_guided);
+	if (!strcmp(name, "wguided"))
+		return (sched_wguided);
+	if (!strcmp(name, "hss"))
+		return (sched_hss);
+	if (!strcmp(name, "kass"))
+		return (sched_kass);
+	if (!strcmp(name, "binlpt"))
+		return (sched_binlpt);
+	if (!strcmp(name, "hbinlpt"))
+		return (sched_hbinlpt);
+	if (!strcmp(name, "srr"))
+		return (sched_srr);
+	if (!strcmp(name, "hybrid"))
+		return (sched_hybrid);
+
+	error("unsupported loop scheduling strategy in decision rules");
+
+	/* Never gets here. */
+	return (NULL);
+}
+
+/**
+ * @brief Converts a chunk size to the chunk parameter of a strategy.
+ *
+ * @details Chunk sizes given to the auto scheduler, either on the
+ * command line or in the decision rules, are in tasks per chunk.
+ * BinLPT takes the number of chunks instead, and KASS the fraction of
+ * its queue taken at a time, so the size is converted for them.
+ *
+ * @param name      Name of the strategy.
+ * @param chunksize Chunk size, in tasks.
+ * @param ntasks    Number of tasks.
+ * @param nthreads  Number of threads.
+ *
+ * @returns The chunk parameter of the target strategy.
+ */
+static int auto_chunksize(const char *name, int chunksize, int ntasks, int nthreads)
+{
+	int n; /* Chunk parameter. */
+
+	/* Number of chunks. */
+	if (!strcmp(name, "binlpt") || !strcmp(name, "hbinlpt"))
+		n = (ntasks + chunksize - 1)/chunksize;
+
+	/* Chunks per queue. */
+	else if (!strcmp(name, "kass"))
+		n = ntasks/(nthreads*chunksize);
+
+	else
+		n = chunksize;
+
+	return ((n > 0) ? n : 1);
+}
+
+/**
+ * @brief Parses a decision rule.
+ *
+ * @param line Rule in text format.
+ * @param rule Decision rule (output).
+ *
+ * @returns True if a rule was parsed, and false if the line is empty.
+ */
+static bool auto_parse_rule(const char *line, struct auto_rule *rule)
+{
+	int n;            /* Number of fields. */
+	char feature[16]; /* Feature name.     */
+
+	/* Skip comments and empty lines. */
+	n = sscanf(line, "%15s %2s %lf %15s %d",
+		feature, rule->op, &rule->threshold, rule->strategy, &rule->chunksize
+	);
+	if ((n <= 0) || (feature[0] == '#'))
+		return (false);
+	if (n < 4)
+		error("bad decision rule");
+	if (n < 5)
+		rule->chunksize = 0;
+
+	/* Parse feature. */
+	for (rule->feature = 0; rule->feature < AUTO_NFEATURES; rule->feature++)
+	{
+		if (!strcmp(feature, auto_feature_names[rule->feature]))
+			break;
+	}
+	if (rule->feature == AUTO_NFEATURES)
+		error("unsupported feature in decision rules");
+
+	/* Check operator. */
+	if ((rule->feature != AUTO_ANY) &&
+		strcmp(rule->op, "<") && strcmp(rule->op, "<=") &&
+		strcmp(rule->op, ">") && strcmp(rule->op, ">="))
+		error("unsupported operator in decision rules");
+
+	auto_lookup(rule->strategy);
+
+	return (true);
+}
+
+/**
+ * @brief Loads decision rules.
+ *
+ * @param rules Decision rules (output).
+ *
+ * @returns The number of decision rules.
+ */
+static int auto_load_rules(struct auto_rule *rules)
+{
+	int n = 0;      /* Number of rules.     */
+	char line[128]; /* Current line.        */
+	FILE *file;     /* Decision rules file. */
+
+	/* Default rules. */
+	if (auto_rules == NULL)
+	{
+		for (int i = 0; auto_default_rules[i] != NULL; i++)
+			n += auto_parse_rule(auto_default_rules[i], &rules[n]);
+
+		return (n);
+	}
+
+	if ((file = fopen(auto_rules, "r")) == NULL)
+		error("failed to open decision rules file");
+
+	while (fgets(line, sizeof(line), file) != NULL)
+	{
+		if (n == AUTO_MAX_RULES)
+			error("too many decision rules");
+
+		n += auto_parse_rule(line, &rules[n]);
+	}
+
+	/* House keeping. */
+	fclose(file);
+
+	return (n);
+}
+
+/**
+ * @brief Computes workload and platform features in a single pass.
+ *
+ * @param workload Target workload.
+ * @param threads  Target threads.
+ * @param features Features (output).
+ */
+static void auto_features(const_workload_tt workload, array_tt threads, double *features)
+{
+	int ntasks;              /* Number of tasks.   */
+	int nthreads;            /* Number of threads. */
+	double s1, s2, s3, slag; /* Raw moments.       */
+	double max;              /* Largest task.      */
+	double mean, var;        /* Workload moments.  */
+	double t1, t2;           /* Thread moments.    */
+
+	ntasks = workload_ntasks(workload);
+	nthreads = array_size(threads);
+
+	/* Workload moments. */
+	s1 = s2 = s3 = slag = max = 0.0;
+	for (int i = 0; i < ntasks; i++)
+	{
+		double x = workload_task(workload, i);
+
+		s1 += x;
+		s2 += x*x;
+		s3 += x*x*x;
+		if (i > 0)
+			slag += x*workload_task(workload, i - 1);
+		if (max < x)
+			max = x;
+	}
+	mean = s1/ntasks;
+	var = s2/ntasks - mean*mean;
+
+	features[AUTO_ANY] = 0.0;
+	features[AUTO_COV] = sqrt(var)/mean;
+	features[AUTO_MAXMEAN] = max/mean;
+	features[AUTO_SKEWNESS] = (var > 0.0) ?
+		(s3/ntasks - 3*mean*s2/ntasks + 2*mean*mean*mean)/pow(var, 1.5) : 0.0;
+	features[AUTO_AUTOCORR] = ((var > 0.0) && (ntasks > 1)) ?
+		(slag/(ntasks - 1) - mean*mean)/var : 0.0;
+
+	/* Thread moments. */
+	t1 = t2 = 0.0;
+	for (int i = 0; i < nthreads; i++)
+	{
+		double c = thread_capacity(array_get(threads, i));
+
+		t1 += c;
+		t2 += c*c;
+	}
+	t1 /= nthreads;
+	t2 = t2/nthreads - t1*t1;
+	features[AUTO_TCOV] = (t2 > 0.0) ? sqrt(t2)/t1 : 0.0;
+}
+
+/**
+ * @brief Asserts if a decision rule matches.
+ *
+ * @param rule     Target decision rule.
+ * @param features Workload and platform features.
+ *
+ * @returns True if the rule matches, and false otherwise.
+ */
+static bool auto_match(const struct auto_rule *rule, const double *features)
+{
+	double x = features[rule->feature];
+
+	if (rule->feature == AUTO_ANY)
+		return (true);
+	if (!strcmp(rule->op, "<"))
+		return (x < rule->threshold);
+	if (!strcmp(rule->op, "<="))
+		return (x <= rule->threshold);
+	if (!strcmp(rule->op, ">"))
+		return (x > rule->threshold);
+
+	return (x >= rule->threshold);
+}
+
+/**
+ * @brief Initializes the auto scheduler.
+ * 
+ * @param workload  Target workload.
+ * @param threads   Target threads.
+ * @param chunksize Chunk size, in tasks.
+ *
+ * @returns The number of tasks planned by the selected strategy.
+ */
+int scheduler_auto_init(const_workload_tt workload, array_tt threads, int chunksize)
+{
+	int nrules;                             /* Number of rules. */
+	double features[AUTO_NFEATURES];        /* Features.        */
+	struct auto_rule rules[AUTO_MAX_RULES]; /* Decision rules.  */
+
+	/* Sanity check. */
+	assert(workload != NULL);
+	assert(threads != NULL);
+	assert(chunksize > 0);
+
+	/* Already initialized, so reuse the selected strategy. */
+	if (scheddata.strategy != NULL)
+		return (scheddata.strategy->init(workload, threads, scheddata.chunksize));
+
+	nrules = auto_load_rules(rules);
+	auto_features(workload, threads, features);
+
+	/* Pick a strategy. */
+	for (int i = 0; i < nrules; i++)
+	{
+		if (!auto_match(&rules[i], features))
+			continue;
+
+		scheddata.strategy = auto_lookup(rules[i].strategy);
+		if (rules[i].chunksize > 0)
+			chunksize = rules[i].chunksize;
+		scheddata.chunksize = auto_chunksize(rules[i].strategy, chunksize,
+			workload_ntasks(workload), array_size(threads)
+		);
+
+		printf("auto: %s\n", rules[i].strategy);
+		break;
+	}
+
+	if (scheddata.strategy == NULL)
+		error("no matching decision rule");
+
+	return (scheddata.strategy->init(workload, threads, scheddata.chunksize));
+}
+
+/**
+ * @brief Finalizes the auto scheduler.
+ */
+void scheduler_auto_end(void)
+{
+	scheddata.strategy->end();
+	scheddata.strategy = NULL;
+}
+
+/**
+ * @brief Auto scheduler.
+ * 
+ * @param running Target queue of running threads.
+ * @param t       Target thread
+ * 
+ * @returns Number scheduled tasks,
+ */
+int scheduler_auto_sched(dqueue_tt running, thread_tt t)
+{
+	return (scheddata.strategy->sched(running, t));
+}
+
+/**
+ * @brief Auto scheduler.
+ */
+static struct scheduler _sched_auto = {
+	false,
+	scheduler_auto_init,
+	scheduler_auto_sched,
+	scheduler_auto_end
+};
+
+const struct scheduler *sched_auto = &_sched_auto;
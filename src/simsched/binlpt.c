@@ -30,15 +30,43 @@
 
 #include <scheduler.h>
 
+/**
+ * @brief Repair plans incrementally?
+ */
+bool binlpt_incremental = false;
+
+/**
+ * @brief Tolerated quality loss of a repaired plan.
+ */
+double binlpt_tolerance = 0.05;
+
 /**
  * @brief BinLPT scheduler data.
  */
 static struct
 {
-	const_workload_tt workload; /**< Workload.   */
-	array_tt threads;           /**< Threads.    */
-	thread_tt *taskmap;         /**< Scheduling. */
-} scheddata = { NULL, NULL, NULL };
+	const_workload_tt workload; /**< Workload.                       */
+	array_tt threads;           /**< Threads.                        */
+	thread_tt *taskmap;         /**< Scheduling.                     */
+	bool *served;               /**< Shares handed out.              */
+	bool hetero;                /**< Account for thread capacities?  */
+	int maxnchunks;             /**< Number of chunks.               */
+	int *chunksizes;            /**< Chunk sizes.                    */
+	int *chunkoff;              /**< Offset to chunks.               */
+	int *chunks;                /**< Chunk weights.                  */
+	int ntypes;                 /**< Number of core types.           */
+	double *chunkcost;          /**< Chunk costs on each core type.  */
+	int *owner;                 /**< Thread assigned to each chunk.  */
+	double *load;               /**< Workload assigned to threads.   */
+	double *capacity;           /**< Processing capacity of threads. */
+	int *type;                  /**< Core type of threads.           */
+	thread_tt *tlist;           /**< Threads, in plan order.         */
+	int *weights;               /**< Task weights seen by the plan.  */
+	double quality;             /**< Quality of the last full plan.  */
+} scheddata = {
+	NULL, NULL, NULL, NULL, false, 0, NULL, NULL, NULL, 1, NULL,
+	NULL, NULL, NULL, NULL, NULL, NULL, 0.0
+};
 
 /*
  * Exchange two numbers.
@@ -198,81 +226,616 @@ static int *binlpt_compute_chunkweights(const_workload_tt workload, const int *c
 	return (chunks);
 }
 
+/**
+ * @brief Computes chunk costs on each core type.
+ *
+ * @details The cost of a chunk on a core type is the sum of the
+ * weights of its tasks, each scaled by the speed factor of its task
+ * class on that core type. Only the heterogeneity-aware mode tells
+ * core types apart.
+ *
+ * @returns Table of chunk costs, one row per chunk.
+ */
+static double *binlpt_compute_chunkcosts(void)
+{
+	double *chunkcost; /* Chunk costs. */
+
+	chunkcost = smalloc(scheddata.maxnchunks*scheddata.ntypes*sizeof(double));
+	for (int k = 0; k < scheddata.maxnchunks*scheddata.ntypes; k++)
+		chunkcost[k] = 0.0;
+
+	for (int k = 0; k < scheddata.maxnchunks; k++)
+	{
+		for (int j = 0; j < scheddata.chunksizes[k]; j++)
+		{
+			int i = scheddata.chunkoff[k] + j;
+			int c = workload_class(scheddata.workload, i);
+
+			for (int y = 0; y < scheddata.ntypes; y++)
+			{
+				chunkcost[k*scheddata.ntypes + y] += (scheddata.hetero) ?
+					workload_task(scheddata.workload, i)*speed_factor(c, y) :
+					workload_task(scheddata.workload, i);
+			}
+		}
+	}
+
+	return (chunkcost);
+}
+
+/**
+ * @brief Cost of a chunk on a thread.
+ *
+ * @param k    Target chunk.
+ * @param tidx Target thread.
+ *
+ * @returns The cost of chunk @p k on the core type of thread @p tidx.
+ */
+static double binlpt_cost(int k, int tidx)
+{
+	return (scheddata.chunkcost[k*scheddata.ntypes + scheddata.type[tidx]]);
+}
+
+/**
+ * @brief Thread capacity class.
+ */
+struct binlpt_class
+{
+	double capacity; /**< Processing capacity. */
+	int type;        /**< Core type.           */
+	int tidx;        /**< Thread index.        */
+};
+
+/**
+ * @brief Compares two thread capacity classes.
+ */
+static int binlpt_class_cmp(const void *a, const void *b)
+{
+	const struct binlpt_class *c1 = a;
+	const struct binlpt_class *c2 = b;
+
+	if (c1->capacity != c2->capacity)
+		return ((c1->capacity < c2->capacity) ? -1 : 1);
+	if (c1->type != c2->type)
+		return ((c1->type < c2->type) ? -1 : 1);
+
+	return (c1->tidx - c2->tidx);
+}
+
+/**
+ * @brief Restores the heap property at the root of a thread heap.
+ *
+ * @param heap  Target thread heap.
+ * @param n     Number of threads in the heap.
+ * @param wsize Workload assigned to threads.
+ */
+static void binlpt_heap_siftdown(int *heap, int n, const double *wsize)
+{
+	int t; /* Temporary value. */
+
+	for (int i = 0, j = 1; j < n; i = j, j = 2*i + 1)
+	{
+		/* Least overloaded child. */
+		if ((j + 1 < n) && (wsize[heap[j + 1]] < wsize[heap[j]]))
+			j++;
+
+		if (wsize[heap[i]] <= wsize[heap[j]])
+			break;
+
+		exch(heap[i], heap[j], t);
+	}
+}
+
+/**
+ * @brief Builds thread heaps, one per processing capacity and core type.
+ *
+ * @param threads  Target threads.
+ * @param heaps    Thread heaps (output).
+ * @param capacity Processing capacity of each heap (output).
+ * @param type     Core type of each heap (output).
+ * @param nheaps   Number of heaps (output).
+ *
+ * @returns Offsets to thread heaps.
+ */
+static int *binlpt_heaps(array_tt threads, int *heaps, double *capacity, int *type, int *nheaps)
+{
+	int nthreads;                 /* Number of threads. */
+	int *heapoff;                 /* Offsets to heaps.  */
+	struct binlpt_class *classes; /* Thread classes.    */
+
+	nthreads = array_size(threads);
+
+	classes = smalloc(nthreads*sizeof(struct binlpt_class));
+	heapoff = smalloc((nthreads + 1)*sizeof(int));
+
+	for (int i = 0; i < nthreads; i++)
+	{
+		classes[i].capacity = scheddata.capacity[i];
+		classes[i].type = scheddata.type[i];
+		classes[i].tidx = i;
+	}
+
+	qsort(classes, nthreads, sizeof(struct binlpt_class), binlpt_class_cmp);
+
+	/*
+	 * All threads start with no workload,
+	 * so each segment is already a heap.
+	 */
+	*nheaps = 0;
+	for (int i = 0; i < nthreads; i++)
+	{
+		if ((i == 0) ||
+			(classes[i].capacity != classes[i - 1].capacity) ||
+			(classes[i].type != classes[i - 1].type))
+		{
+			capacity[*nheaps] = classes[i].capacity;
+			type[*nheaps] = classes[i].type;
+			heapoff[(*nheaps)++] = i;
+		}
+
+		heaps[i] = classes[i].tidx;
+	}
+	heapoff[*nheaps] = nthreads;
+
+	/* House keeping. */
+	free(classes);
+
+	return (heapoff);
+}
+
+/**
+ * @brief Estimates the makespan of the current plan.
+ *
+ * @returns The finish time of the most overloaded thread.
+ */
+static double binlpt_makespan(void)
+{
+	double makespan = 0.0;
+
+	for (int i = 0; i < array_size(scheddata.threads); i++)
+	{
+		double f = scheddata.load[i]*scheddata.capacity[i];
+
+		if (makespan < f)
+			makespan = f;
+	}
+
+	return (makespan);
+}
+
+/**
+ * @brief Assesses the quality of the current plan.
+ *
+ * @returns The ratio between the estimated makespan of the current
+ * plan and a lower bound on the optimal makespan.
+ */
+static double binlpt_quality(void)
+{
+	int nthreads;          /* Number of threads.    */
+	double total = 0.0;    /* Total workload.       */
+	double speed = 0.0;    /* Aggregate speed.      */
+	double maxchunk = 0.0; /* Heaviest chunk.       */
+	double mincost;        /* Cheapest chunk cost.  */
+	double mincapacity;    /* Fastest thread.       */
+	double lb;             /* Makespan lower bound. */
+
+	nthreads = array_size(scheddata.threads);
+
+	mincapacity = scheddata.capacity[0];
+	for (int i = 0; i < nthreads; i++)
+	{
+		speed += 1.0/scheddata.capacity[i];
+		if (mincapacity > scheddata.capacity[i])
+			mincapacity = scheddata.capacity[i];
+	}
+	for (int k = 0; k < scheddata.maxnchunks; k++)
+	{
+		mincost = scheddata.chunkcost[k*scheddata.ntypes];
+		for (int y = 1; y < scheddata.ntypes; y++)
+		{
+			if (mincost > scheddata.chunkcost[k*scheddata.ntypes + y])
+				mincost = scheddata.chunkcost[k*scheddata.ntypes + y];
+		}
+
+		total += mincost;
+		if (maxchunk < mincost)
+			maxchunk = mincost;
+	}
+
+	lb = total/speed;
+	if (lb < maxchunk*mincapacity)
+		lb = maxchunk*mincapacity;
+
+	return ((lb > 0.0) ? binlpt_makespan()/lb : 1.0);
+}
+
+/**
+ * @brief Assigns a chunk to a thread.
+ *
+ * @param k    Target chunk.
+ * @param tidx Target thread.
+ */
+static void binlpt_assign(int k, int tidx)
+{
+	if (scheddata.owner[k] >= 0)
+		scheddata.load[scheddata.owner[k]] -= binlpt_cost(k, scheddata.owner[k]);
+
+	scheddata.owner[k] = tidx;
+	scheddata.load[tidx] += binlpt_cost(k, tidx);
+
+	for (int j = 0; j < scheddata.chunksizes[k]; j++)
+		scheddata.taskmap[scheddata.chunkoff[k] + j] = scheddata.tlist[tidx];
+}
+
+/**
+ * @brief Computes a full BinLPT plan.
+ */
+static void binlpt_plan(void)
+{
+	int ntasks;       /* Number of tasks.          */
+	int nthreads;     /* Number of threads.        */
+	int *map;         /* Chunk sorting map.        */
+	int *sorted;      /* Sorted chunk weights.     */
+	int *heaps;       /* Thread heaps.             */
+	int *heapoff;     /* Offset to thread heaps.   */
+	double *capacity; /* Capacity of thread heaps. */
+	int *type;        /* Type of thread heaps.     */
+	int nheaps;       /* Number of thread heaps.   */
+
+	ntasks = workload_ntasks(scheddata.workload);
+	nthreads = array_size(scheddata.threads);
+
+	for (int i = 0; i < ntasks; i++)
+		scheddata.weights[i] = workload_task(scheddata.workload, i);
+	for (int i = 0; i < nthreads; i++)
+	{
+		thread_tt t = array_get(scheddata.threads, i);
+
+		scheddata.tlist[i] = t;
+		scheddata.capacity[i] = (scheddata.hetero) ? thread_capacity(t) : 1.0;
+		scheddata.type[i] = (scheddata.hetero) ? thread_type(t) : 0;
+		scheddata.load[i] = 0.0;
+	}
+
+	scheddata.chunksizes = binlpt_compute_chunksizes(scheddata.workload, scheddata.maxnchunks);
+	scheddata.chunks = binlpt_compute_chunkweights(scheddata.workload, scheddata.chunksizes, scheddata.maxnchunks);
+	scheddata.chunkoff = binlpt_compute_commulative_sum(scheddata.chunksizes, scheddata.maxnchunks);
+	scheddata.chunkcost = binlpt_compute_chunkcosts();
+	scheddata.owner = smalloc(scheddata.maxnchunks*sizeof(int));
+	for (int i = 0; i < scheddata.maxnchunks; i++)
+		scheddata.owner[i] = -1;
+
+	sorted = smalloc(scheddata.maxnchunks*sizeof(int));
+	memcpy(sorted, scheddata.chunks, scheddata.maxnchunks*sizeof(int));
+	map = binlpt_chunk_sortmap(sorted, scheddata.maxnchunks);
+
+	/* Group threads by processing capacity and core type. */
+	heaps = smalloc(nthreads*sizeof(int));
+	capacity = smalloc(nthreads*sizeof(double));
+	type = smalloc(nthreads*sizeof(int));
+	heapoff = binlpt_heaps(scheddata.threads, heaps, capacity, type, &nheaps);
+
+	/* Assign tasks to threads. */
+	for (int i = scheddata.maxnchunks; i > 0; i--)
+	{
+		int tidx;  /* Least overloaded thread. */
+		int h = 0; /* Heap of target thread.   */
+
+		if (sorted[i - 1] == 0)
+			continue;
+
+		nchunks++;
+
+		/* Search for least overloaded thread. */
+		if (!scheddata.hetero)
+		{
+			tidx = 0;
+			for (int j = 1; j < nthreads; j++)
+			{
+				if (scheddata.load[j] < scheddata.load[tidx])
+					tidx = j;
+			}
+		}
+
+		/* Search for thread that finishes first. */
+		else
+		{
+			int k = map[i - 1]*scheddata.ntypes;
+
+			for (int j = 1; j < nheaps; j++)
+			{
+				double f1 = (scheddata.load[heaps[heapoff[j]]] + scheddata.chunkcost[k + type[j]])*capacity[j];
+				double f2 = (scheddata.load[heaps[heapoff[h]]] + scheddata.chunkcost[k + type[h]])*capacity[h];
+
+				if (f1 < f2)
+					h = j;
+			}
+
+			tidx = heaps[heapoff[h]];
+		}
+
+		binlpt_assign(map[i - 1], tidx);
+
+		if (scheddata.hetero)
+			binlpt_heap_siftdown(&heaps[heapoff[h]], heapoff[h + 1] - heapoff[h], scheddata.load);
+	}
+
+	scheddata.quality = binlpt_quality();
+	
+	/* House keeping. */
+	free(heapoff);
+	free(type);
+	free(capacity);
+	free(heaps);
+	free(map);
+	free(sorted);
+}
+
+/**
+ * @brief Discards the current BinLPT plan.
+ */
+static void binlpt_unplan(void)
+{
+	free(scheddata.owner);
+	free(scheddata.chunkcost);
+	free(scheddata.chunkoff);
+	free(scheddata.chunks);
+	free(scheddata.chunksizes);
+}
+
+/**
+ * @brief Finds the chunk that holds a task.
+ *
+ * @param i Target task.
+ *
+ * @returns The chunk that holds the target task.
+ */
+static int binlpt_chunk(int i)
+{
+	int lo = 0;
+	int hi = scheddata.maxnchunks - 1;
+
+	/* Last chunk that starts at or before i. */
+	while (lo < hi)
+	{
+		int mid = lo + (hi - lo + 1)/2;
+
+		if (scheddata.chunkoff[mid] <= i)
+			lo = mid;
+		else
+			hi = mid - 1;
+	}
+
+	return (lo);
+}
+
+/**
+ * @brief Repairs the current BinLPT plan.
+ *
+ * @details Updates the weights of the chunks that hold the changed
+ * tasks, and then greedily moves chunks away from the threads whose
+ * load changed, for a number of moves bounded by the number of such
+ * threads. If the quality of the repaired plan degrades beyond
+ * binlpt_tolerance of that of the last full plan, the plan is fully
+ * recomputed instead.
+ *
+ * @param changed  Tasks whose weight changed in the workload.
+ * @param nchanged Number of changed tasks.
+ *
+ * @returns The number of tasks planned again.
+ */
+int binlpt_repair(const int *changed, int nchanged)
+{
+	int nrepaired;  /* Tasks planned again.        */
+	int nthreads;   /* Number of threads.          */
+	int ninvolved;  /* Number of involved threads. */
+	bool *involved; /* Is thread involved?         */
+
+	/* Sanity check. */
+	assert(scheddata.taskmap != NULL);
+	assert((changed != NULL) || (nchanged == 0));
+
+	nthreads = array_size(scheddata.threads);
+	involved = smalloc(nthreads*sizeof(bool));
+	for (int j = 0; j < nthreads; j++)
+		involved[j] = false;
+
+	/* Update chunk weights. */
+	ninvolved = 0;
+	for (int j = 0; j < nchanged; j++)
+	{
+		int i = changed[j];
+		int k = binlpt_chunk(i);
+		int c = workload_class(scheddata.workload, i);
+		int delta = workload_task(scheddata.workload, i) - scheddata.weights[i];
+
+		scheddata.weights[i] += delta;
+		scheddata.chunks[k] += delta;
+		scheddata.load[scheddata.owner[k]] -= binlpt_cost(k, scheddata.owner[k]);
+		for (int y = 0; y < scheddata.ntypes; y++)
+		{
+			scheddata.chunkcost[k*scheddata.ntypes + y] += (scheddata.hetero) ?
+				delta*speed_factor(c, y) : delta;
+		}
+		scheddata.load[scheddata.owner[k]] += binlpt_cost(k, scheddata.owner[k]);
+
+		if (!involved[scheddata.owner[k]])
+		{
+			involved[scheddata.owner[k]] = true;
+			ninvolved++;
+		}
+	}
+
+	/* Rebalance involved threads. */
+	for (int moves = 2*ninvolved; moves > 0; moves--)
+	{
+		int a = -1;                /* Overloaded thread.  */
+		int b = 0;                 /* Underloaded thread. */
+		int best = -1;             /* Chunk to move.      */
+		double fa = 0.0, fb = 0.0; /* Finish times.       */
+		double fbest;              /* Best finish time.   */
+
+		for (int i = 0; i < nthreads; i++)
+		{
+			double fi = scheddata.load[i]*scheddata.capacity[i];
+
+			if (involved[i] && ((a < 0) || (fi > fa)))
+			{
+				a = i;
+				fa = fi;
+			}
+			if ((i == 0) || (fi < fb))
+			{
+				b = i;
+				fb = fi;
+			}
+		}
+
+		if ((a < 0) || (a == b))
+			break;
+
+		/* Chunk whose move best lowers the finish time of a. */
+		fbest = fa;
+		for (int k = 0; k < scheddata.maxnchunks; k++)
+		{
+			double f1, f2;
+
+			if (scheddata.owner[k] != a)
+				continue;
+
+			f1 = (scheddata.load[a] - binlpt_cost(k, a))*scheddata.capacity[a];
+			f2 = (scheddata.load[b] + binlpt_cost(k, b))*scheddata.capacity[b];
+			if (f1 < f2)
+				f1 = f2;
+
+			if (f1 < fbest)
+			{
+				best = k;
+				fbest = f1;
+			}
+		}
+
+		if (best < 0)
+			break;
+
+		binlpt_assign(best, b);
+		involved[b] = true;
+	}
+
+	nrepaired = nchanged;
+
+	/* Fall back to a full recompute. */
+	if (binlpt_quality() > (1.0 + binlpt_tolerance)*scheddata.quality)
+	{
+		binlpt_unplan();
+		binlpt_plan();
+		nrepaired = workload_ntasks(scheddata.workload);
+	}
+
+	/* House keeping. */
+	free(involved);
+
+	return (nrepaired);
+}
+
 /**
  * @brief Initializes the binlpt scheduler.
  * 
  * @param workload  Target workload.
  * @param threads   Target threads.
  * @param chunksize Chunk size.
+ * @param hetero    Account for thread capacities?
+ *
+ * @returns The number of tasks planned.
  */
-void scheduler_binlpt_init(const_workload_tt workload, array_tt threads, int chunksize)
+static int binlpt_init(const_workload_tt workload, array_tt threads, int chunksize, bool hetero)
 {
-	int ntasks;      /* Number of tasks.              */
-	int nthreads;    /* Number of threads.            */
-	int *map;        /* Task sorting map.             */
-	int *wsize;      /* Workload assigned to threads. */
-	int *chunksizes; /* Chunks sizes.                 */
-	int *chunks;     /* Chunks.                       */
-	int *chunkoff;   /* Offset to chunks.             */
-	int maxnchunks;  /* Number of chunks.             */
+	int ntasks;   /* Number of tasks.   */
+	int nthreads; /* Number of threads. */
 	
 	/* Sanity check. */
 	assert(workload != NULL);
 	assert(threads != NULL);
 	assert(chunksize > 0);
 
-	/* Already initialized. */
+	/* Already initialized, so repair the plan. */
 	if (scheddata.taskmap != NULL)
-		return;
+	{
+		int *changed; /* Changed tasks.           */
+		int nchanged; /* Number of changed tasks. */
+
+		for (int j = 0; j < array_size(threads); j++)
+			scheddata.served[j] = false;
+
+		if (!binlpt_incremental)
+			return (0);
+
+		ntasks = workload_ntasks(workload);
+		changed = smalloc(ntasks*sizeof(int));
+
+		nchanged = 0;
+		for (int i = 0; i < ntasks; i++)
+		{
+			if (workload_task(workload, i) != scheddata.weights[i])
+				changed[nchanged++] = i;
+		}
+
+		nchanged = binlpt_repair(changed, nchanged);
+
+		free(changed);
+		return (nchanged);
+	}
 	
 	ntasks = workload_ntasks(workload);
-	maxnchunks = chunksize;
 	nthreads = array_size(threads);
 
 	/* Initialize scheduler data. */
 	scheddata.workload = workload;
 	scheddata.threads = threads;
+	scheddata.hetero = hetero;
+	scheddata.ntypes = (hetero) ? speed_ntypes : 1;
+	scheddata.maxnchunks = chunksize;
 	scheddata.taskmap = smalloc(ntasks*sizeof(thread_tt));
+	scheddata.served = smalloc(array_size(threads)*sizeof(bool));
+	for (int j = 0; j < array_size(threads); j++)
+		scheddata.served[j] = false;
+	scheddata.weights = smalloc(ntasks*sizeof(int));
+	scheddata.load = smalloc(nthreads*sizeof(double));
+	scheddata.capacity = smalloc(nthreads*sizeof(double));
+	scheddata.type = smalloc(nthreads*sizeof(int));
+	scheddata.tlist = smalloc(nthreads*sizeof(thread_tt));
+
+	binlpt_plan();
+
+	return (ntasks);
+}
 
-	chunksizes = binlpt_compute_chunksizes(workload, maxnchunks);
-	chunks = binlpt_compute_chunkweights(workload, chunksizes, maxnchunks);
-	chunkoff = binlpt_compute_commulative_sum(chunksizes, maxnchunks);
-
-	map = binlpt_chunk_sortmap(chunks, maxnchunks);
-	wsize = smalloc(nthreads*sizeof(int));
-	memset(wsize, 0, nthreads*sizeof(int));
-
-	/* Assign tasks to threads. */
-	for (int i = maxnchunks; i > 0; i--)
-	{
-		int k;    /* Alias for current chunk. */
-		int tidx; /* Least overloaded thread. */
-
-		if (chunks[i - 1] == 0)
-			continue;
-
-		nchunks++;
-
-		/* Search for least overloaded thread. */
-		tidx = 0;
-		for (int j = 1; j < array_size(threads); j++)
-		{
-			if (wsize[j] < wsize[tidx])
-				tidx = j;
-		}
+/**
+ * @brief Initializes the binlpt scheduler.
+ * 
+ * @param workload  Target workload.
+ * @param threads   Target threads.
+ * @param chunksize Chunk size.
+ *
+ * @returns The number of tasks planned.
+ */
+int scheduler_binlpt_init(const_workload_tt workload, array_tt threads, int chunksize)
+{
+	return (binlpt_init(workload, threads, chunksize, false));
+}
 
-		k = map[i - 1];
-		for (int j = 0; j < chunksizes[k]; j++)
-			scheddata.taskmap[chunkoff[k] + j] = array_get(threads, tidx);
-		wsize[tidx] += chunks[i - 1];
-	}
-	
-	/* House keeping. */
-	free(wsize);
-	free(map);
-	free(chunkoff);
-	free(chunks);
-	free(chunksizes);
+/**
+ * @brief Initializes the heterogeneity-aware binlpt scheduler.
+ * 
+ * @param workload  Target workload.
+ * @param threads   Target threads.
+ * @param chunksize Chunk size.
+ *
+ * @returns The number of tasks planned.
+ */
+int scheduler_hbinlpt_init(const_workload_tt workload, array_tt threads, int chunksize)
+{
+	return (binlpt_init(workload, threads, chunksize, true));
 }
 
 /**
@@ -280,6 +843,13 @@ void scheduler_binlpt_init(const_workload_tt workload, array_tt threads, int chu
  */
 void scheduler_binlpt_end(void)
 {
+	binlpt_unplan();
+	free(scheddata.tlist);
+	free(scheddata.type);
+	free(scheddata.capacity);
+	free(scheddata.load);
+	free(scheddata.weights);
+	free(scheddata.served);
 	free(scheddata.taskmap);
 	scheddata.taskmap = NULL;
 }
@@ -296,6 +866,13 @@ int scheduler_binlpt_sched(dqueue_tt running, thread_tt t)
 {
 	int n = 0;     /* Number of tasks scheduled. */
 	int wsize = 0; /* Size of assigned work.     */
+	int tidx;      /* Thread index.              */
+
+	/* Share already handed out. */
+	tidx = thread_gettid(t)%array_size(scheddata.threads);
+	if (scheddata.served[tidx])
+		return (0);
+	scheddata.served[tidx] = true;
 
 	/* Get next tasks. */
 	for (int i = 0; i < workload_ntasks(scheddata.workload); i++)
@@ -305,8 +882,7 @@ int scheduler_binlpt_sched(dqueue_tt running, thread_tt t)
 			continue;
 
 		n++;
-		wsize += workload_task(scheddata.workload, i);
-		thread_assign(t, workload_task(scheddata.workload, i));
+		wsize += thread_assign(t, scheddata.workload, i);
 	}
 	
 	dqueue_insert(running, t, wsize);
@@ -326,3 +902,14 @@ static struct scheduler _sched_binlpt = {
 
 const struct scheduler *sched_binlpt = &_sched_binlpt;
 
+/**
+ * @brief Heterogeneity-aware BinLPT scheduler.
+ */
+static struct scheduler _sched_hbinlpt = {
+	false,
+	scheduler_hbinlpt_init,
+	scheduler_binlpt_sched,
+	scheduler_binlpt_end
+};
+
+const struct scheduler *sched_hbinlpt = &_sched_hbinlpt;
@@ -0,0 +1,229 @@
+/*
+ * Copyright(C) 2016 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ * 
+ * This file is part of Scheduler.
+ *
+ * Scheduler is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ * 
+ * Scheduler is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Scheduler; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include <mylib/util.h>
+#include <mylib/dqueue.h>
+#include <mylib/queue.h>
+
+#include <scheduler.h>
+
+/**
+ * @brief CCP scheduler data.
+ */
+static struct
+{
+	int *wqueues_start;         /**< Start of work queues. */
+	int *wqueues_end;           /**< End of work queues.   */
+	const_workload_tt workload; /**< Workload.             */
+	array_tt threads;           /**< Threads.              */
+} scheddata = { NULL, NULL, NULL, NULL };
+
+/**
+ * @brief Assigns contiguous blocks under a bottleneck.
+ *
+ * @details Each thread, in order, takes the longest block whose
+ * processing time does not exceed the bottleneck.
+ *
+ * @param wsum       Cummulative workload.
+ * @param ntasks     Number of tasks.
+ * @param capacity   Processing capacity of threads.
+ * @param nthreads   Number of threads.
+ * @param bottleneck Target bottleneck.
+ * @param end        End of blocks (output). May be NULL.
+ *
+ * @returns True if all tasks fit under the target bottleneck, and false
+ * otherwise.
+ */
+static bool ccp_probe(const long *wsum, int ntasks, const double *capacity, int nthreads, long bottleneck, int *end)
+{
+	int i0 = 0; /* First task of current block. */
+
+	for (int j = 0; j < nthreads; j++)
+	{
+		int lo, hi; /* Search range.    */
+		long limit; /* Last prefix sum. */
+
+		limit = wsum[i0] + (long) floor(bottleneck/capacity[j]);
+
+		/* Last prefix sum that fits. */
+		lo = i0; hi = ntasks;
+		while (lo < hi)
+		{
+			int mid = hi - (hi - lo)/2;
+
+			if (wsum[mid] <= limit)
+				lo = mid;
+			else
+				hi = mid - 1;
+		}
+
+		i0 = lo;
+		if (end != NULL)
+			end[j] = i0;
+	}
+
+	return (i0 == ntasks);
+}
+
+/**
+ * @brief Initializes the CCP scheduler.
+ * 
+ * @param workload  Target workload.
+ * @param threads   Target threads.
+ * @param chunksize Chunk size.
+ *
+ * @returns The number of tasks planned.
+ */
+int scheduler_ccp_init(const_workload_tt workload, array_tt threads, int chunksize)
+{
+	int ntasks;       /* Number of tasks.         */
+	int nthreads;     /* Number of threads.       */
+	double *capacity; /* Capacity of work queues. */
+	long *wsum;       /* Cummulative workload.    */
+	long lo, hi;      /* Bottleneck search range. */
+	
+	((void) chunksize);
+
+	/* Sanity check. */
+	assert(workload != NULL);
+	assert(threads != NULL);
+
+	/* Already initialized, so rewind work queues. */
+	if (scheddata.wqueues_start != NULL)
+	{
+		for (int j = 0; j < array_size(threads); j++)
+			scheddata.wqueues_start[j] = (j == 0) ? 0 : scheddata.wqueues_end[j - 1];
+		return (0);
+	}
+	
+	ntasks = workload_ntasks(workload);
+	nthreads = array_size(threads);
+
+	/* Initialize scheduler data. */
+	scheddata.workload = workload;
+	scheddata.threads = threads;
+	scheddata.wqueues_start = smalloc(nthreads*sizeof(int));
+	scheddata.wqueues_end = smalloc(nthreads*sizeof(int));
+
+	/* Work queue i is owned by thread i. */
+	capacity = smalloc(nthreads*sizeof(double));
+	for (int i = 0; i < nthreads; i++)
+	{
+		thread_tt t = array_get(threads, i);
+		capacity[thread_gettid(t)%nthreads] = thread_capacity(t);
+	}
+
+	wsum = smalloc((ntasks + 1)*sizeof(long));
+	wsum[0] = 0;
+	for (int i = 0; i < ntasks; i++)
+		wsum[i + 1] = wsum[i] + workload_task(workload, i);
+
+	/*
+	 * Binary search for the smallest feasible bottleneck. The
+	 * whole workload on the first thread is feasible, up to
+	 * rounding of fractional capacities.
+	 */
+	lo = 0; hi = (long) ceil(wsum[ntasks]*capacity[0]);
+	while (!ccp_probe(wsum, ntasks, capacity, nthreads, hi, NULL))
+		hi = 2*hi + 1;
+	while (lo < hi)
+	{
+		long mid = lo + (hi - lo)/2;
+
+		if (ccp_probe(wsum, ntasks, capacity, nthreads, mid, NULL))
+			hi = mid;
+		else
+			lo = mid + 1;
+	}
+
+	/* Create work queues. */
+	ccp_probe(wsum, ntasks, capacity, nthreads, lo, scheddata.wqueues_end);
+	for (int j = 0; j < nthreads; j++)
+	{
+		scheddata.wqueues_start[j] = (j == 0) ? 0 : scheddata.wqueues_end[j - 1];
+		if (scheddata.wqueues_start[j] < scheddata.wqueues_end[j])
+			nchunks++;
+	}
+
+	/* House keeping. */
+	free(wsum);
+	free(capacity);
+
+	return (ntasks);
+}
+
+/**
+ * @brief Finalizes the CCP scheduler.
+ */
+void scheduler_ccp_end(void)
+{
+	free(scheddata.wqueues_end);
+	free(scheddata.wqueues_start);
+	scheddata.wqueues_end = NULL;
+	scheddata.wqueues_start = NULL;
+}
+
+/**
+ * @brief CCP scheduler.
+ * 
+ * @param running Target queue of running threads.
+ * @param t       Target thread
+ * 
+ * @returns Number scheduled tasks,
+ */
+int scheduler_ccp_sched(dqueue_tt running, thread_tt t)
+{
+	int n;         /* Number of tasks scheduled. */
+	int wqueue;    /* Work queue.                */
+	int wsize = 0; /* Size of assigned work.     */
+
+	wqueue = thread_gettid(t)%array_size(scheddata.threads);
+
+	/* Done. */
+	if (scheddata.wqueues_start[wqueue] < 0)
+		return (0);
+
+	n = scheddata.wqueues_end[wqueue] - scheddata.wqueues_start[wqueue];
+	for (int i = scheddata.wqueues_start[wqueue]; i < scheddata.wqueues_end[wqueue]; i++)
+		wsize += thread_assign(t, scheddata.workload, i);
+	scheddata.wqueues_start[wqueue] = -1;
+	
+	dqueue_insert(running, t, wsize);
+
+	return (n);
+}
+
+/**
+ * @brief CCP scheduler.
+ */
+static struct scheduler _sched_ccp = {
+	false,
+	scheduler_ccp_init,
+	scheduler_ccp_sched,
+	scheduler_ccp_end
+};
+
+const struct scheduler *sched_ccp = &_sched_ccp;
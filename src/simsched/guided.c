@@ -46,8 +46,10 @@ static struct
  * @param workload  Target workload.
  * @param threads   Target threads.
  * @param chunksize Chunk size.
+ *
+ * @returns The number of tasks planned.
  */
-void scheduler_guided_init(const_workload_tt workload, array_tt threads, int chunksize)
+int scheduler_guided_init(const_workload_tt workload, array_tt threads, int chunksize)
 {
 	/* Sanity check. */
 	assert(workload != NULL);
@@ -59,6 +61,8 @@ void scheduler_guided_init(const_workload_tt workload, array_tt threads, int chu
 	scheddata.workload = workload;
 	scheddata.threads = threads;
 	scheddata.chunksize = chunksize;
+
+	return (0);
 }
 
 /**
@@ -104,8 +108,7 @@ int scheduler_guided_sched(dqueue_tt running, thread_tt t)
 	wsize = 0;
 	for (int i = scheddata.i0; i < (scheddata.i0 + chunksize); i++)
 	{
-		wsize += workload_task(scheddata.workload, i);
-		thread_assign(t, workload_task(scheddata.workload, i));
+		wsize += thread_assign(t, scheddata.workload, i);
 	}
 
 	/* Update schedule data. */
@@ -48,8 +48,10 @@ static struct
  * @param workload  Target workload.
  * @param threads   Target threads.
  * @param chunksize Chunk size.
+ *
+ * @returns The number of tasks planned.
  */
-void scheduler_hss_init(const_workload_tt workload, array_tt threads, int chunksize)
+int scheduler_hss_init(const_workload_tt workload, array_tt threads, int chunksize)
 {
 	int ntasks;     /* Number of tasks. */
 	int wremaining; /* Total workload.  */
@@ -71,6 +73,8 @@ void scheduler_hss_init(const_workload_tt workload, array_tt threads, int chunks
 	scheddata.threads = threads;
 	scheddata.chunksize = chunksize;
 	scheddata.wremaining = wremaining;
+
+	return (0);
 }
 
 /**
@@ -93,21 +97,26 @@ int scheduler_hss_sched(dqueue_tt running, thread_tt t)
 	int n;        /* Number of tasks scheduled.      */
 	int k;        /* Number of scheduled iterations. */
 	int wsize;    /* Size of assigned work.          */
+	int time;     /* Processing time.                */
 	int ntasks;   /* Number of tasks.                */
 	int nthreads; /* Number of hteads.               */
 
-	nchunks++;
-
 	ntasks = workload_ntasks(scheddata.workload);
 	nthreads = array_size(scheddata.threads);
 
+	/* Done. */
+	if (scheddata.i0 == ntasks)
+		return (0);
+
+	nchunks++;
+
 	/* Comput chunksize. */
 	n = ceil(scheddata.wremaining/(1.5*nthreads));
 	if (n < scheddata.chunksize)
 		n = scheddata.chunksize;
 
 	/* Schedule iterations. */
-	wsize = 0; k = 0;
+	wsize = 0; k = 0; time = 0;
 	for (int i = scheddata.i0; i < ntasks; i++)
 	{
 		int w1;
@@ -115,7 +124,7 @@ int scheduler_hss_sched(dqueue_tt running, thread_tt t)
 
 		k++;
 		wsize += workload_task(scheddata.workload, i);
-		thread_assign(t, workload_task(scheddata.workload, i));
+		time += thread_assign(t, scheddata.workload, i);
 
 		w1 = wsize;
 		w2 = (i + 1 < ntasks) ? 
@@ -138,7 +147,7 @@ int scheduler_hss_sched(dqueue_tt running, thread_tt t)
 	scheddata.i0 += k;
 	scheddata.wremaining -= wsize;
 	
-	dqueue_insert(running, t, wsize);
+	dqueue_insert(running, t, time);
 
 	return (k);
 }
@@ -0,0 +1,218 @@
+/*
+ * Copyright(C) 2016 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ * 
+ * This file is part of Scheduler.
+ *
+ * Scheduler is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ * 
+ * Scheduler is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Scheduler; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include <mylib/util.h>
+#include <mylib/dqueue.h>
+#include <mylib/queue.h>
+
+#include <scheduler.h>
+
+/**
+ * @brief Fraction of the iteration space that is statically scheduled.
+ */
+double hybrid_fraction = 0.75;
+
+/**
+ * @brief Scheduling scheme for the remainder of the iteration space.
+ */
+enum hybrid_tail hybrid_tail = HYBRID_TAIL_DYNAMIC;
+
+/**
+ * @brief Hybrid scheduler data.
+ */
+static struct
+{
+	int i0;                     /**< Last iteration scheduled.     */
+	int nstatic;                /**< Statically scheduled tasks.   */
+	int *wqueues_start;         /**< Start of static work queues.  */
+	int *wqueues_end;           /**< End of static work queues.    */
+	const_workload_tt workload; /**< Workload.                     */
+	array_tt threads;           /**< Threads.                      */
+	int chunksize;              /**< Chunksize.                    */
+} scheddata = { 0, 0, NULL, NULL, NULL, NULL, 1 };
+
+/**
+ * @brief Computes the static partitioning.
+ *
+ * @details Splits the first nstatic iterations into one contiguous
+ * block per thread, each block carrying about the same load, as KASS
+ * does for homogeneous platforms.
+ */
+static void scheduler_hybrid_static(void)
+{
+	int nthreads; /* Number of threads. */
+
+	nthreads = array_size(scheddata.threads);
+
+	/* Initialize work queues. */
+	for (int i = 0; i < nthreads; i++)
+	{
+		scheddata.wqueues_start[i] = scheddata.nstatic;
+		scheddata.wqueues_end[i] = scheddata.nstatic - 1;
+	}
+
+	workload_partition(scheddata.workload, scheddata.nstatic, nthreads,
+		scheddata.wqueues_start,
+		scheddata.wqueues_end
+	);
+
+	/* Work queues end past their last task. */
+	for (int i = 0; i < nthreads; i++)
+		scheddata.wqueues_end[i]++;
+}
+
+/**
+ * @brief Initializes the hybrid scheduler.
+ *
+ * @param workload  Target workload.
+ * @param threads   Target threads.
+ * @param chunksize Chunk size.
+ *
+ * @returns The number of tasks planned.
+ */
+int scheduler_hybrid_init(const_workload_tt workload, array_tt threads, int chunksize)
+{
+	int nthreads; /* Number of threads. */
+
+	/* Sanity check. */
+	assert(workload != NULL);
+	assert(threads != NULL);
+	assert(chunksize > 0);
+	assert((hybrid_fraction >= 0.0) && (hybrid_fraction <= 1.0));
+
+	/* Already initialized, so rewind work queues. */
+	if (scheddata.wqueues_start != NULL)
+	{
+		scheddata.i0 = scheddata.nstatic;
+		for (int j = 0; j < array_size(threads); j++)
+			scheddata.wqueues_start[j] = (j == 0) ? 0 : scheddata.wqueues_end[j - 1];
+		return (0);
+	}
+
+	nthreads = array_size(threads);
+
+	/* Initialize scheduler data. */
+	scheddata.workload = workload;
+	scheddata.threads = threads;
+	scheddata.chunksize = chunksize;
+	scheddata.nstatic = hybrid_fraction*workload_ntasks(workload);
+	scheddata.i0 = scheddata.nstatic;
+	scheddata.wqueues_start = smalloc(nthreads*sizeof(int));
+	scheddata.wqueues_end = smalloc(nthreads*sizeof(int));
+
+	scheduler_hybrid_static();
+
+	return (workload_ntasks(workload));
+}
+
+/**
+ * @brief Finalizes the hybrid scheduler.
+ */
+void scheduler_hybrid_end(void)
+{
+	free(scheddata.wqueues_end);
+	free(scheddata.wqueues_start);
+	scheddata.wqueues_end = NULL;
+	scheddata.wqueues_start = NULL;
+}
+
+/**
+ * @brief Hybrid scheduler.
+ *
+ * @details A thread first runs its static block and then fetches
+ * chunks from the shared tail of the iteration space.
+ *
+ * @param running Target queue of running threads.
+ * @param t       Target thread
+ *
+ * @returns Number scheduled tasks,
+ */
+int scheduler_hybrid_sched(dqueue_tt running, thread_tt t)
+{
+	int i0;        /* First iteration scheduled. */
+	int tidx;      /* Static work queue.         */
+	int chunksize; /* Number of tasks scheduled. */
+	int wsize;     /* Size of assigned work.     */
+	int ntasks;    /* Number of tasks.           */
+	int nthreads;  /* Number of threads.         */
+
+	ntasks = workload_ntasks(scheddata.workload);
+	nthreads = array_size(scheddata.threads);
+	tidx = thread_gettid(t)%nthreads;
+
+	/* Static block. */
+	if (scheddata.wqueues_start[tidx] < scheddata.wqueues_end[tidx])
+	{
+		i0 = scheddata.wqueues_start[tidx];
+		chunksize = scheddata.wqueues_end[tidx] - i0;
+		scheddata.wqueues_start[tidx] = scheddata.wqueues_end[tidx];
+	}
+
+	/* Dynamic tail. */
+	else
+	{
+		/* Done. */
+		if (scheddata.i0 == ntasks)
+			return (0);
+
+		/* Compute chunksize. */
+		chunksize = scheddata.chunksize;
+		if (hybrid_tail == HYBRID_TAIL_GUIDED)
+		{
+			if (chunksize < (ntasks - scheddata.i0)/(2*nthreads))
+				chunksize = (ntasks - scheddata.i0)/(2*nthreads);
+		}
+		if (chunksize > ntasks - scheddata.i0)
+			chunksize = ntasks - scheddata.i0;
+
+		i0 = scheddata.i0;
+		scheddata.i0 += chunksize;
+	}
+
+	nchunks++;
+
+	/* Schedule iterations. */
+	wsize = 0;
+	for (int i = i0; i < i0 + chunksize; i++)
+	{
+		wsize += thread_assign(t, scheddata.workload, i);
+	}
+
+	dqueue_insert(running, t, wsize);
+
+	return (chunksize);
+}
+
+/**
+ * @brief Hybrid scheduler.
+ */
+static struct scheduler _sched_hybrid = {
+	false,
+	scheduler_hybrid_init,
+	scheduler_hybrid_sched,
+	scheduler_hybrid_end
+};
+
+const struct scheduler *sched_hybrid = &_sched_hybrid;
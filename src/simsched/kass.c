@@ -41,9 +41,12 @@ static struct
 	int *wqueues_start;         /**< Start of work queues.             */
 	int *wqueues_end;           /**< Length of work queues.            */
 	int *wqueues_i0;            /**< Current iteration on work queues. */
+	double *wqueues_capacity;   /**< Capacity of work queue owners.    */
+	double *wqueues_rate;       /**< Speed of work queue owners.       */
+	int *wsum;                  /**< Cummulative workload.             */
 	const_workload_tt workload; /**< Workload.                         */
 	array_tt threads;           /**< Threads.                          */
-} scheddata = { 0, 0, NULL, NULL, NULL, NULL, NULL };
+} scheddata = { 0, 0, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL };
 
 /**
  * @brief Computes the static partitioning for a uniform workload.
@@ -52,42 +55,55 @@ static void scheduler_kass_static_uniform_workload(void)
 {
 	int ntasks;   /* Number of tasks.   */
 	int nthreads; /* Number of threads. */
-	int chunklen; /* Chunk size.        */
 	
 	ntasks = workload_ntasks(scheddata.workload);
 	nthreads = array_size(scheddata.threads);
-	chunklen = ntasks/nthreads;
 	
 	/* Create work queues. */
-	scheddata.wqueues_start[0] = 0;
-	for (int i = 0, j = 0; i < ntasks; i += chunklen)
+	for (int j = 0; j < nthreads; j++)
 	{
-		if (i == (ntasks - 1))
-		{
-			scheddata.wqueues_end[j] = ntasks - 1;
-			break;
-		}
-
-		j++;
+		scheddata.wqueues_start[j] = ((long) j*ntasks)/nthreads;
+		scheddata.wqueues_end[j] = ((long) (j + 1)*ntasks)/nthreads - 1;
 	}
 }
 
 /**
  * @brief Computes the static partitioning for a homogeneous platform.
  */
-static void scheduler_kass_static_homogeneous_platform(int wsize)
+static void scheduler_kass_static_homogeneous_platform(void)
+{
+	workload_partition(scheddata.workload,
+		workload_ntasks(scheddata.workload),
+		array_size(scheddata.threads),
+		scheddata.wqueues_start,
+		scheddata.wqueues_end
+	);
+}
+
+/**
+ * @brief Computes the static partitioning for a heterogeneous platform.
+ *
+ * @details Each work queue gets a share of the workload that is
+ * proportional to the processing speed (1/capacity) of its owner.
+ */
+static void scheduler_kass_static_heterogeneous_platform(int wsize)
 {
-	int size;        /* Size of current chunk. */
-	int ntasks;      /* Number of tasks.       */
-	int nthreads;    /* Number of threads.     */
-	int chunkweight; /* Chunk size.            */
+	double size;   /* Size of current chunk.  */
+	double speed;  /* Total processing speed. */
+	double target; /* Size of current queue.  */
+	int ntasks;    /* Number of tasks.        */
+	int nthreads;  /* Number of threads.      */
 	
 	ntasks = workload_ntasks(scheddata.workload);
 	nthreads = array_size(scheddata.threads);
-	chunkweight = wsize/nthreads;
+
+	speed = 0.0;
+	for (int j = 0; j < nthreads; j++)
+		speed += scheddata.wqueues_rate[j];
 	
 	/* Create work queues. */
 	size = 0;
+	target = wsize*scheddata.wqueues_rate[0]/speed;
 	scheddata.wqueues_start[0] = 0;
 	for (int i = 0, j = 0; i < ntasks; i++)
 	{
@@ -98,11 +114,12 @@ static void scheduler_kass_static_homogeneous_platform(int wsize)
 		}
 
 		/* Next partition. */
-		if (size >= chunkweight)
+		if (size >= target)
 		{
 			scheddata.wqueues_end[j++] = i - 1;
 
 			size = 0;
+			target = wsize*scheddata.wqueues_rate[j]/speed;
 			scheddata.wqueues_start[j] = i;
 		}
 		
@@ -206,12 +223,12 @@ static void scheduler_kass_static(void)
 	thread_stats(NULL, &tmean, &tstddev);
 
 	/* Compute initial partitioning. */
-	if (wstddev/wmean < 0.1)
+	if (tstddev/tmean >= 0.1)
+		scheduler_kass_static_heterogeneous_platform(wtotal);
+	else if (wstddev/wmean < 0.1)
 		scheduler_kass_static_uniform_workload();
-	else if (tstddev/tmean < 0.1)
-		scheduler_kass_static_homogeneous_platform(wtotal);
 	else
-		error("heterogeneous platforms currently unsupported");
+		scheduler_kass_static_homogeneous_platform();
 
 	/* Initialize head of work queues. */
 	for (int i = 0; i < nthreads; i++)
@@ -228,8 +245,10 @@ static void scheduler_kass_static(void)
  * @param workload  Target workload.
  * @param threads   Target threads.
  * @param chunkweight Chunk size.
+ *
+ * @returns The number of tasks planned.
  */
-void scheduler_kass_init(const_workload_tt workload, array_tt threads, int chunksize)
+int scheduler_kass_init(const_workload_tt workload, array_tt threads, int chunksize)
 {
 	int nthreads;
 	
@@ -238,9 +257,13 @@ void scheduler_kass_init(const_workload_tt workload, array_tt threads, int chunk
 	assert(threads != NULL);
 	assert(chunksize > 0);
 
-	/* Already initialized. */
+	/* Already initialized, so rewind work queues. */
 	if (scheddata.initialized)
-		return;
+	{
+		for (int i = 0; i < array_size(threads); i++)
+			scheddata.wqueues_i0[i] = scheddata.wqueues_start[i];
+		return (0);
+	}
 	
 	/* Aliases. */
 	nthreads = array_size(threads);
@@ -252,10 +275,23 @@ void scheduler_kass_init(const_workload_tt workload, array_tt threads, int chunk
 	scheddata.wqueues_start = smalloc(nthreads*sizeof(int));
 	scheddata.wqueues_end = smalloc(nthreads*sizeof(int));
 	scheddata.wqueues_i0 = smalloc(nthreads*sizeof(int));
+	scheddata.wqueues_capacity = smalloc(nthreads*sizeof(double));
+	scheddata.wqueues_rate = smalloc(nthreads*sizeof(double));
+	scheddata.wsum = workload_cummulative_sum(workload);
+
+	/* Work queue i is owned by thread i. */
+	for (int i = 0; i < nthreads; i++)
+	{
+		thread_tt t = array_get(threads, i);
+		scheddata.wqueues_capacity[thread_gettid(t)%nthreads] = thread_capacity(t);
+		scheddata.wqueues_rate[thread_gettid(t)%nthreads] = thread_rate(t);
+	}
 
 	scheduler_kass_static();
 
 	scheddata.initialized = 1;
+
+	return (workload_ntasks(workload));
 }
 
 /**
@@ -263,14 +299,35 @@ void scheduler_kass_init(const_workload_tt workload, array_tt threads, int chunk
  */
 void scheduler_kass_end(void)
 {
+	free(scheddata.wsum);
+	free(scheddata.wqueues_rate);
+	free(scheddata.wqueues_capacity);
 	free(scheddata.wqueues_i0);
 	free(scheddata.wqueues_end);
 	free(scheddata.wqueues_start);
 	scheddata.initialized = 0;
 }
 
+/**
+ * @brief Asserts if a work queue has unscheduled iterations.
+ *
+ * @param wqueue Target work queue.
+ *
+ * @returns True if the target work queue is not empty, and false otherwise.
+ */
+static inline bool scheduler_kass_pending(int wqueue)
+{
+	if (scheddata.wqueues_i0[wqueue] < 0)
+		return (false);
+
+	return (scheddata.wqueues_i0[wqueue] <= scheddata.wqueues_end[wqueue]);
+}
+
 /**
  * @brief KASS scheduler.
+ *
+ * @details A thread consumes its own work queue first, and then helps
+ * the work queue that is expected to finish last.
  * 
  * @param running Target queue of running threads.
  * @param t       Target thread
@@ -291,18 +348,32 @@ int scheduler_kass_sched(dqueue_tt running, thread_tt t)
 
 	wqueue = tid%nthreads;
 
-	/* Find an unfinished working queue. */
-	for (wqueue = (tid + 1)%nthreads; ; wqueue = (wqueue + 1)%nthreads)
+	/* Find the unfinished working queue that finishes last. */
+	if (!scheduler_kass_pending(wqueue))
 	{
-		/* Done. */
-		if (wqueue == (tid%nthreads))
-			return (0);
+		double tmax = 0.0; /* Expected finish time. */
 
-		if (scheddata.wqueues_i0[wqueue] < 0)
-			continue;
+		wqueue = -1;
+		for (int i = 0; i < nthreads; i++)
+		{
+			double ti;
 
-		if (scheddata.wqueues_i0[wqueue] <= scheddata.wqueues_end[wqueue])
-			break;
+			if (!scheduler_kass_pending(i))
+				continue;
+
+			ti = ((double) scheddata.wsum[scheddata.wqueues_end[i] + 1] -
+				scheddata.wsum[scheddata.wqueues_i0[i]])*scheddata.wqueues_capacity[i];
+
+			if ((wqueue < 0) || (ti > tmax))
+			{
+				wqueue = i;
+				tmax = ti;
+			}
+		}
+
+		/* Done. */
+		if (wqueue < 0)
+			return (0);
 	}
 
 	nremaining = scheddata.wqueues_end[wqueue] - scheddata.wqueues_i0[wqueue] + 1;
@@ -320,8 +391,7 @@ int scheduler_kass_sched(dqueue_tt running, thread_tt t)
 	wsize = 0;
 	for (int i = scheddata.wqueues_i0[wqueue]; i < (scheddata.wqueues_i0[wqueue] + chunksize); i++)
 	{
-		wsize += workload_task(scheddata.workload, i);
-		thread_assign(t, workload_task(scheddata.workload, i));
+		wsize += thread_assign(t, scheddata.workload, i);
 
 		if (i == scheddata.wqueues_end[wqueue])
 		{
@@ -0,0 +1,145 @@
+/*
+ * Copyright(C) 2016 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ * 
+ * This file is part of Scheduler.
+ *
+ * Scheduler is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ * 
+ * Scheduler is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Scheduler; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include <mylib/util.h>
+#include <mylib/dqueue.h>
+#include <mylib/queue.h>
+
+#include <scheduler.h>
+
+/**
+ * @brief LPT scheduler data.
+ */
+static struct
+{
+	int i0;                     /**< Last iteration scheduled. */
+	int *map;                   /**< Task sorting map.         */
+	const_workload_tt workload; /**< Workload.                 */
+	array_tt threads;           /**< Threads.                  */
+	int chunksize;              /**< Chunksize.                */
+} scheddata = { 0, NULL, NULL, NULL, 1 };
+
+/**
+ * @brief Initializes the LPT scheduler.
+ * 
+ * @details Sorting the tasks by decreasing cost is the plan of LPT.
+ *
+ * @param workload  Target workload.
+ * @param threads   Target threads.
+ * @param chunksize Chunk size.
+ *
+ * @returns The number of tasks planned.
+ */
+int scheduler_lpt_init(const_workload_tt workload, array_tt threads, int chunksize)
+{
+	/* Sanity check. */
+	assert(workload != NULL);
+	assert(threads != NULL);
+	assert(chunksize > 0);
+
+	/* Already initialized, so rewind. */
+	if (scheddata.map != NULL)
+	{
+		scheddata.i0 = 0;
+		return (0);
+	}
+
+	/* Initialize scheduler data. */
+	scheddata.i0 = 0;
+	scheddata.map = workload_sortmap(workload);
+	scheddata.workload = workload;
+	scheddata.threads = threads;
+	scheddata.chunksize = chunksize;
+
+	return (workload_ntasks(workload));
+}
+
+/**
+ * @brief Finalizes the LPT scheduler.
+ */
+void scheduler_lpt_end(void)
+{
+	free(scheddata.map);
+	scheddata.map = NULL;
+}
+
+/**
+ * @brief LPT scheduler.
+ *
+ * @details Tasks are dispatched from a shared queue, in descending
+ * order of weight.
+ * 
+ * @param running Target queue of running threads.
+ * @param t       Target thread
+ * 
+ * @returns Number scheduled tasks,
+ */
+int scheduler_lpt_sched(dqueue_tt running, thread_tt t)
+{
+	int chunksize; /* Number of tasks scheduled. */
+	int wsize;     /* Size of assigned work.     */
+	int ntasks;    /* Number of tasks.           */
+
+	ntasks = workload_ntasks(scheddata.workload);
+
+	/* Done. */
+	if (scheddata.i0 == ntasks)
+		return (0);
+
+	nchunks++;
+
+	/* Comput chunksize. */
+	chunksize = scheddata.chunksize;
+	if (chunksize > (ntasks - scheddata.i0))
+		chunksize = ntasks - scheddata.i0;
+
+	/* Schedule tasks, largest first. */
+	wsize = 0;
+	for (int i = scheddata.i0; i < scheddata.i0 + chunksize; i++)
+	{
+		int k = scheddata.map[ntasks - i - 1];
+
+		wsize += thread_assign(t, scheddata.workload, k);
+	}
+	
+	/* Update scheduler data. */
+	scheddata.i0 += chunksize;
+
+	dqueue_insert(running, t, wsize);
+
+	return (chunksize);
+}
+
+/**
+ * @brief LPT scheduler.
+ */
+static struct scheduler _sched_lpt = {
+	false,
+	scheduler_lpt_init,
+	scheduler_lpt_sched,
+	scheduler_lpt_end
+};
+
+const struct scheduler *sched_lpt = &_sched_lpt;
@@ -41,7 +41,16 @@ static struct
 	const struct scheduler *scheduler; /**< Loop scheduling strategy. */
 	int chunksize;                     /**< Chunk size.               */
 	void (*kernel)(workload_tt);       /**< Application kernel.       */
-} args = { NULL, NULL, NULL, 1, NULL };
+	bool oracle;                       /**< Report optimality gap?    */
+	double noise;                      /**< Estimation noise.         */
+	FILE *input;                       /**< Input workload file.      */
+	int nsteps;                        /**< Number of time steps.     */
+	double drift;                      /**< Workload drift per step.  */
+	int replan;                        /**< Replanning period.        */
+	const struct scheduler *outer;     /**< Strategy across nodes.    */
+	int outerchunk;                    /**< Chunk size across nodes.  */
+	bool traces;                       /**< Thread traces given?      */
+} args = { NULL, NULL, NULL, 1, NULL, false, 0.0, NULL, 1, 0.0, 1, NULL, 0, false };
 
 /*============================================================================*
  * KERNELS                                                                    *
@@ -73,10 +82,14 @@ static void kernel_logarithmic(workload_tt w)
 	for (int i = 0; i < workload_ntasks(w); i++)
 	{
 		int load;
+		int actual;
 
 		load = workload_task(w, i);
+		actual = workload_actual(w, i);
 		load = floor(load*(log(load)/log(2.0)));
+		actual = floor(actual*(log(actual)/log(2.0)));
 		workload_set_task(w, i, load);
+		workload_set_actual(w, i, actual);
 	}
 }
 
@@ -90,10 +103,14 @@ static void kernel_quadratic(workload_tt w)
 	for (int i = 0; i < workload_ntasks(w); i++)
 	{
 		int load;
+		int actual;
 
 		load = workload_task(w, i);
+		actual = workload_actual(w, i);
 		load = load*load;
+		actual = actual*actual;
 		workload_set_task(w, i, load);
+		workload_set_actual(w, i, actual);
 	}
 }
 
@@ -109,23 +126,80 @@ static void usage(void)
 	printf("Usage: simsched [options] <scheduler>\n");
 	printf("Brief: loop scheduler simulator\n");
 	printf("Options:\n");
+	printf("  --affinity            Keep caches across time steps.\n");
 	printf("  --arch <filename>     Architecture file.\n");
+	printf("  --background <filename> Background utilisation file.\n");
+	printf("  --barrier <number>    Barrier cost per tree level.\n");
+	printf("  --bgoff <number>      Mean idle period (background).\n");
+	printf("  --bgon <number>       Mean busy period (background).\n");
+	printf("  --bgshare <number>    Relative speed when sharing (background).\n");
 	printf("  --chunksize <number>  Chunk size.\n");
+	printf("  --contention <number> Cost per concurrent dispatch.\n");
+	printf("  --drift <number>      Workload drift per time step.\n");
+	printf("  --elastic <filename>  Thread arrival and departure file.\n");
+	printf("  --footprint <number>  Memory footprint of a task.\n");
+	printf("  --fraction <number>   Static fraction (hybrid).\n");
 	printf("  --kernel <name>       Kernel complexity.\n");
 	printf("           linear          Linear kernel\n");
 	printf("           logarithmic     Logarithm kernel\n");
 	printf("           quadratic       Quadratic kernel\n");
 	printf("  --input <filename>    Input workload file\n");
+	printf("  --intensity <number>  Memory intensity of tasks.\n");
+	printf("  --interval <number>   Mean time between stalls (jitter).\n");
+	printf("  --jitter <name>       Jitter model.\n");
+	printf("           periodic        Periodic interrupts\n");
+	printf("           random          Random stalls\n");
+	printf("  --latency <number>    Inter-node dispatch latency.\n");
+	printf("  --nodes <number>      Number of nodes.\n");
+	printf("  --noise <number>      Noise in cost estimates.\n");
+	printf("  --nsteps <number>     Number of time steps.\n");
 	printf("  --nthreads <number>   Number of working threads.\n");
+	printf("  --oracle              Report optimality gap (base model).\n");
+	printf("  --outer <name>        Strategy across nodes.\n");
+	printf("  --outerchunk <number> Chunk size across nodes.\n");
+	printf("  --overhead <number>   Cost per dispatch.\n");
+	printf("  --pin                 Pin threads to cores.\n");
+	printf("  --plancost <number>   Planning cost per task.\n");
+	printf("  --quantum <number>    Time slice (oversubscription).\n");
+	printf("  --redistcost <number> Cost per redistributed task.\n");
+	printf("  --redistribute <name> Redistribution policy (elastic).\n");
+	printf("           steal           Any idle thread, chunk by chunk\n");
+	printf("           adopt           First idle thread, all work\n");
+	printf("  --repair <number>     Repair plans within tolerance (binlpt).\n");
+	printf("  --replan <number>     Replanning period (0 for never).\n");
+	printf("  --reuse <number>      Relative cost of a task run again.\n");
+	printf("  --rules <filename>    Decision rules file (auto).\n");
+	printf("  --skew <number>       Mean delay between thread wake-ups.\n");
+	printf("  --speed <filename>    Speed trace file.\n");
+	printf("  --stall <number>      Length of a stall (jitter).\n");
+	printf("  --starts <filename>   Start offset file.\n");
+	printf("  --switch <number>     Context switch cost.\n");
+	printf("  --tail <name>         Tail scheduler (hybrid).\n");
+	printf("           dynamic         Dynamic Scheduling\n");
+	printf("           guided          Guided Scheduling\n");
+	printf("  --timeslice <name>    Time-slicing policy.\n");
+	printf("           rr              Round-robin\n");
+	printf("           cfs             Least run time first\n");
+	printf("  --wakeup <name>       Thread wake-up model.\n");
+	printf("           linear          One after the other\n");
+	printf("           random          At random delays\n");
+	printf("  --warm <number>       Relative cost of a cached task.\n");
 	printf("  --help                Display this message.\n");
 	printf("Loop Schedulers:\n");
 	printf("  guided   Guided Scheduling\n");
+	printf("  wguided  Workload-Aware Guided Scheduling\n");
 	printf("  dynamic  Dynamic Scheduling\n");
+	printf("  lpt      Largest-First Dynamic Scheduling\n");
 	printf("  hss      History-Aware Scheduling\n");
 	printf("  kass     Knowledge-Based Scheduling\n");
 	printf("  binlpt   Bin Packing LPT Scheduling\n");
+	printf("  hbinlpt  Heterogeneity-Aware BinLPT Scheduling\n");
 	printf("  srr      Smart Round-Robin Scheduling\n");
 	printf("  static   Static Scheduling\n");
+	printf("  ccp      Optimal Contiguous Partitioning\n");
+	printf("  hybrid   Hybrid Static/Dynamic Scheduling\n");
+	printf("  oracle   Near-Optimal Offline Scheduling\n");
+	printf("  auto     Workload-Aware Strategy Selection\n");
 
 	exit(EXIT_SUCCESS);
 }
@@ -133,29 +207,253 @@ static void usage(void)
 /**
  * @brief Gets workload.
  *
+ * @details The input workload file is kept open, as it may carry the
+ * workloads of later time steps.
+ *
  * @param filename Input workload filename.
  *
  * @returns A workload.
  */
 static workload_tt get_workload(const char *filename)
 {
-	FILE *input;   /* Input workload file. */
-	workload_tt w; /* Workload.            */
-
-	input = fopen(filename, "r");
-	if (input == NULL)
+	args.input = fopen(filename, "r");
+	if (args.input == NULL)
 		error("cannot open input workload file");
 
-	w = workload_read(input);
+	return (workload_read(args.input));
+}
+
+/**
+ * @brief Checks that task classes are in the speed matrix.
+ *
+ * @param w Target workload.
+ */
+static void check_classes(const_workload_tt w)
+{
+	for (int i = 0; i < workload_ntasks(w); i++)
+	{
+		if (workload_class(w, i) >= speed_nclasses)
+			error("task class missing in speed matrix");
+	}
+}
+
+/**
+ * @brief Advances the workload to the next time step.
+ *
+ * @details The next workload in the input workload file is used, if
+ * any. Otherwise, the current workload drifts.
+ *
+ * @param w Target workload.
+ */
+static void next_workload(workload_tt w)
+{
+	workload_tt next; /* Next workload. */
+
+	/* Skip blank lines. */
+	if ((fscanf(args.input, " ") == EOF) || (feof(args.input)))
+	{
+		workload_drift(w, args.drift);
+		return;
+	}
+
+	next = workload_read(args.input);
+	if (workload_ntasks(next) != workload_ntasks(w))
+		error("workloads differ in size across time steps");
+
+	check_classes(next);
+	workload_copy(w, next);
+	workload_destroy(next);
+
+	args.kernel(w);
+	workload_perturb(w, args.noise);
+}
+
+/**
+ * @brief Reads a value for each core in the architecture file.
+ *
+ * @param file   Architecture file.
+ * @param values Values (output).
+ * @param ncores Number of cores.
+ */
+static void get_core_values(FILE *file, int *values, int ncores)
+{
+	for (int i = 0; i < ncores; i++)
+	{
+		if ((fscanf(file, "%d", &values[i]) != 1) || (values[i] < 0))
+			error("bad architecture file");
+	}
+}
+
+/**
+ * @brief Reads the processing capacities of cores.
+ *
+ * @details Capacities are relative costs, so they may be fractional
+ * (e.g. 1.37 for a core that is 37% slower than the reference one).
+ *
+ * @param file     Architecture file.
+ * @param capacity Processing capacities (output).
+ * @param ncores   Number of cores.
+ */
+static void get_core_capacities(FILE *file, double *capacity, int ncores)
+{
+	for (int i = 0; i < ncores; i++)
+	{
+		if ((fscanf(file, "%lf", &capacity[i]) != 1) || (capacity[i] <= 0.0))
+			error("bad architecture file");
+	}
+}
+
+/**
+ * @brief Reads the machine topology in the architecture file.
+ *
+ * @details The topology is given by optional directives that follow
+ * the processing capacities of cores. Directives that list a value per
+ * core take one value for each core, with defaults in parentheses:
+ *
+ *   sockets <number>      Cores split evenly into sockets (one).
+ *   nodes <node>...       NUMA node of each core (its socket).
+ *   caches <cache>...     Shared cache of each core (its socket).
+ *   remote <number>       Remote access multiplier.
+ *   cachesize <number>    Size of the cache of each core (in bytes).
+ *   bandwidth <number>    Memory bandwidth (bytes per unit of time).
+ *   smt <core>...         Physical core of each core (own core).
+ *   corun <number>        Relative speed of a core whose SMT sibling is
+ *                         busy.
+ *   types <type>...       Core type of each core (all zero).
+ *   matrix <m> <n> <x>... Relative cost of m task classes on n core
+ *                         types, one row per task class.
+ *
+ * @param file   Architecture file.
+ * @param ncores Number of cores.
+ * @param socket Socket of cores (output).
+ * @param node   NUMA node of cores (output).
+ * @param cache  Shared cache of cores (output).
+ * @param type   Core type of cores (output).
+ * @param core   Physical core of cores (output).
+ */
+static void get_topology(FILE *file, int ncores, int *socket, int *node, int *cache, int *type, int *core)
+{
+	char directive[32];  /* Current directive. */
+	bool nodes = false;  /* Nodes given?      */
+	bool caches = false; /* Caches given?     */
+	int ntypes = 1;      /* Core types.        */
+
+	for (int i = 0; i < ncores; i++)
+	{
+		socket[i] = 0;
+		type[i] = 0;
+		core[i] = i;
+	}
+
+	while (fscanf(file, "%31s", directive) == 1)
+	{
+		if (!strcmp(directive, "sockets"))
+		{
+			int nsockets;
+
+			if ((fscanf(file, "%d", &nsockets) != 1) || (nsockets < 1) || (nsockets > ncores))
+				error("bad architecture file");
+
+			for (int i = 0; i < ncores; i++)
+				socket[i] = ((long) i)*nsockets/ncores;
+		}
+		else if (!strcmp(directive, "nodes"))
+		{
+			get_core_values(file, node, ncores);
+			nodes = true;
+		}
+		else if (!strcmp(directive, "caches"))
+		{
+			get_core_values(file, cache, ncores);
+			caches = true;
+		}
+		else if (!strcmp(directive, "remote"))
+		{
+			if ((fscanf(file, "%lf", &numa_remote) != 1) || (numa_remote < 1.0))
+				error("bad architecture file");
+		}
+		else if (!strcmp(directive, "cachesize"))
+		{
+			if ((fscanf(file, "%d", &locality_cache) != 1) || (locality_cache < 0))
+				error("bad architecture file");
+		}
+		else if (!strcmp(directive, "bandwidth"))
+		{
+			if ((fscanf(file, "%lf", &bandwidth_limit) != 1) || (bandwidth_limit < 0.0))
+				error("bad architecture file");
+		}
+		else if (!strcmp(directive, "smt"))
+			get_core_values(file, core, ncores);
+		else if (!strcmp(directive, "corun"))
+		{
+			if ((fscanf(file, "%lf", &smt_corun) != 1) || (smt_corun <= 0.0) || (smt_corun > 1.0))
+				error("bad architecture file");
+		}
+		else if (!strcmp(directive, "types"))
+		{
+			get_core_values(file, type, ncores);
+			for (int i = 0; i < ncores; i++)
+			{
+				if (ntypes <= type[i])
+					ntypes = type[i] + 1;
+			}
+		}
+		else if (!strcmp(directive, "matrix"))
+		{
+			if ((fscanf(file, "%d %d", &speed_nclasses, &speed_ntypes) != 2) ||
+				(speed_nclasses < 1) || (speed_ntypes < 1))
+				error("bad architecture file");
+
+			speed_matrix = smalloc(speed_nclasses*speed_ntypes*sizeof(double));
+			for (int i = 0; i < speed_nclasses*speed_ntypes; i++)
+			{
+				if ((fscanf(file, "%lf", &speed_matrix[i]) != 1) || (speed_matrix[i] <= 0.0))
+					error("bad architecture file");
+			}
+		}
+		else
+			error("unknown directive in architecture file");
+	}
+
+	/* Defaults. */
+	for (int i = 0; i < ncores; i++)
+	{
+		if (!nodes)
+			node[i] = socket[i];
+		if (!caches)
+			cache[i] = socket[i];
+	}
 
-	fclose(input);
+	numa_nnodes = 1;
+	for (int i = 0; i < ncores; i++)
+	{
+		if (numa_nnodes <= node[i])
+			numa_nnodes = node[i] + 1;
+	}
+
+	smt_ncores = 0;
+	for (int i = 0; i < ncores; i++)
+	{
+		if (smt_ncores <= core[i])
+			smt_ncores = core[i] + 1;
+	}
 
-	return (w);
+	/* Core types. */
+	if (speed_matrix == NULL)
+		speed_ntypes = ntypes;
+	else if (ntypes > speed_ntypes)
+		error("core type missing in speed matrix");
 }
 
 /**
  * @brief Gets threads.
  *
+ * @details The architecture file gives the number of cores, followed
+ * by the processing capacity of each core, even if fewer threads are
+ * used, and then by the topology directives. Threads in excess of cores
+ * are bound to cores in a round-robin fashion, and take turns to run on
+ * them.
+ *
  * @param filename Architecture filename.
  * @param nthreads Number of working threads.
  *
@@ -163,41 +461,373 @@ static workload_tt get_workload(const char *filename)
  */
 static array_tt get_threads(const char *filename, int nthreads)
 {
-	FILE *file;       /* Architecture file. */
-	int ncores;       /* Number of cores.   */
-	array_tt threads; /* Working threads.   */
+	FILE *file;       /* Architecture file.      */
+	int ncores;       /* Number of cores.        */
+	double *capacity; /* Capacity of cores.      */
+	int *socket;      /* Socket of cores.        */
+	int *node;        /* NUMA node of cores.     */
+	int *cache;       /* Shared cache of cores.  */
+	int *type;        /* Core type of cores.     */
+	int *core;        /* Physical core of cores. */
+	array_tt threads; /* Working threads.        */
 
 	assert(nthreads > 0);
 
 	if ((file = fopen(filename, "r")) == NULL)
 		error("failed to open architecture file");
 
-	assert(fscanf(file, "%d", &ncores) == 1);
-	if (nthreads < 1)
+	if ((fscanf(file, "%d", &ncores) != 1) || (ncores < 1))
 		error("bad architecture file");
 
-	if (nthreads > ncores)
-		error("too many threads for target architecture");
+	capacity = smalloc(ncores*sizeof(double));
+	socket = smalloc(ncores*sizeof(int));
+	node = smalloc(ncores*sizeof(int));
+	cache = smalloc(ncores*sizeof(int));
+	type = smalloc(ncores*sizeof(int));
+	core = smalloc(ncores*sizeof(int));
+
+	get_core_capacities(file, capacity, ncores);
+	get_topology(file, ncores, socket, node, cache, type, core);
+	timeslice_ncpus = ncores;
 
 	threads = array_create(nthreads);
 
 	for (int i = 0; i < nthreads; i++)
 	{
-		thread_tt t;  /* Thread.                       */
-		int capacity; /* Thread's processing capacity. */
-		
-		assert(fscanf(file, "%d", &capacity) == 1);
+		thread_tt t; /* Thread. */
 
-		t = thread_create(capacity);
+		t = thread_create(capacity[i%ncores]);
+		thread_set_topology(t, socket[i%ncores], node[i%ncores], cache[i%ncores]);
+		thread_set_type(t, type[i%ncores]);
+		thread_set_core(t, core[i%ncores]);
+		thread_set_cpu(t, i%ncores);
 		array_set(threads, i, t);
 	}
 
 	/* House keeping. */
+	free(core);
+	free(type);
+	free(cache);
+	free(node);
+	free(socket);
+	free(capacity);
 	fclose(file);
 
 	return (threads);
 }
 
+/**
+ * @brief Gets speed traces.
+ *
+ * @details Each line of the speed trace file reads "<thread> <time>
+ * <rate>", meaning that the thread runs at the given relative speed
+ * from that time on. Lines of a thread come in increasing order of
+ * time.
+ *
+ * @param filename Speed trace filename.
+ * @param threads  Working threads.
+ */
+static void get_speed(const char *filename, array_tt threads)
+{
+	FILE *file;   /* Speed trace file.    */
+	int tidx;     /* Thread index.        */
+	double time;  /* Start of a segment.  */
+	double rate;  /* Speed in a segment.  */
+	double *last; /* Last time of thread. */
+	int ret;      /* Return value.        */
+
+	if ((file = fopen(filename, "r")) == NULL)
+		error("failed to open speed trace file");
+
+	last = smalloc(array_size(threads)*sizeof(double));
+	for (int i = 0; i < array_size(threads); i++)
+		last[i] = -1.0;
+
+	while ((ret = fscanf(file, "%d %lf %lf", &tidx, &time, &rate)) == 3)
+	{
+		if ((tidx < 0) || (tidx >= array_size(threads)))
+			error("bad speed trace file");
+
+		if ((time < 0.0) || (time <= last[tidx]) || (rate <= 0.0))
+			error("bad speed trace file");
+
+		thread_set_speed(array_get(threads, tidx), time, rate);
+		last[tidx] = time;
+	}
+
+	if (ret != EOF)
+		error("bad speed trace file");
+
+	free(last);
+	fclose(file);
+}
+
+/**
+ * @brief Gets background load.
+ *
+ * @details Each line of the background utilisation file reads "<core>
+ * <time> <utilisation>", meaning that other tenants take that fraction
+ * of the core from that time on. Lines of a core come in increasing
+ * order of time.
+ *
+ * @param filename Background utilisation filename.
+ */
+static void get_background(const char *filename)
+{
+	FILE *file;   /* Utilisation file.     */
+	int core;     /* Core index.           */
+	double time;  /* Start of a segment.   */
+	double load;  /* Load in a segment.    */
+	double *last; /* Last time per core.   */
+	int ret;      /* Return value.         */
+
+	if ((file = fopen(filename, "r")) == NULL)
+		error("failed to open background utilisation file");
+
+	last = smalloc(timeslice_ncpus*sizeof(double));
+	for (int i = 0; i < timeslice_ncpus; i++)
+		last[i] = -1.0;
+
+	while ((ret = fscanf(file, "%d %lf %lf", &core, &time, &load)) == 3)
+	{
+		if ((core < 0) || (core >= timeslice_ncpus))
+			error("bad background utilisation file");
+
+		if ((time < 0.0) || (time <= last[core]) || (load < 0.0) || (load >= 1.0))
+			error("bad background utilisation file");
+
+		background_set(core, time, load);
+		last[core] = time;
+	}
+
+	if (ret != EOF)
+		error("bad background utilisation file");
+
+	free(last);
+	fclose(file);
+}
+
+/**
+ * @brief Gets start offsets.
+ *
+ * @details Each line of the start offset file reads "<thread>
+ * <offset>", meaning that the thread wakes up that long after the
+ * start of the loop.
+ *
+ * @param filename Start offset filename.
+ * @param threads  Working threads.
+ */
+static void get_starts(const char *filename, array_tt threads)
+{
+	FILE *file;    /* Start offset file. */
+	int tidx;      /* Thread index.      */
+	double offset; /* Start offset.      */
+	int ret;       /* Return value.      */
+
+	if ((file = fopen(filename, "r")) == NULL)
+		error("failed to open start offset file");
+
+	while ((ret = fscanf(file, "%d %lf", &tidx, &offset)) == 2)
+	{
+		if ((tidx < 0) || (tidx >= array_size(threads)))
+			error("bad start offset file");
+
+		if (offset < 0.0)
+			error("bad start offset file");
+
+		thread_set_offset(array_get(threads, tidx), offset);
+	}
+
+	if (ret != EOF)
+		error("bad start offset file");
+
+	fclose(file);
+}
+
+/**
+ * @brief Gets thread arrivals and departures.
+ *
+ * @details Each line of the elasticity file reads "<thread> <arrival>
+ * <departure>", meaning that the thread joins the loop at the time of
+ * arrival and leaves it at once at the time of departure, leaving the
+ * rest of its current chunk to other threads. The time of departure
+ * may be "inf".
+ *
+ * @param filename Elasticity filename.
+ * @param threads  Working threads.
+ */
+static void get_elastic(const char *filename, array_tt threads)
+{
+	FILE *file;       /* Elasticity file.   */
+	int tidx;         /* Thread index.      */
+	double arrival;   /* Time of arrival.   */
+	double departure; /* Time of departure. */
+	int ret;          /* Return value.      */
+
+	if ((file = fopen(filename, "r")) == NULL)
+		error("failed to open elasticity file");
+
+	while ((ret = fscanf(file, "%d %lf %lf", &tidx, &arrival, &departure)) == 3)
+	{
+		if ((tidx < 0) || (tidx >= array_size(threads)))
+			error("bad elasticity file");
+
+		if ((arrival < 0.0) || (departure <= arrival))
+			error("bad elasticity file");
+
+		thread_set_window(array_get(threads, tidx), arrival, departure);
+	}
+
+	if (ret != EOF)
+		error("bad elasticity file");
+
+	fclose(file);
+}
+
+/**
+ * @brief Gets redistribution policy.
+ *
+ * @param policyname Redistribution policy name.
+ *
+ * @returns Redistribution policy.
+ */
+static enum elastic_policy get_redistribute(const char *policyname)
+{
+	if (!strcmp(policyname, "steal"))
+		return (ELASTIC_STEAL);
+	if (!strcmp(policyname, "adopt"))
+		return (ELASTIC_ADOPT);
+
+	error("unsupported redistribution policy");
+
+	/* Never gets here. */
+	return (ELASTIC_STEAL);
+}
+
+/**
+ * @brief Gets wake-up model.
+ *
+ * @param wakeupname Wake-up model name.
+ *
+ * @returns Wake-up model.
+ */
+static enum wakeup_model get_wakeup(const char *wakeupname)
+{
+	if (!strcmp(wakeupname, "linear"))
+		return (WAKEUP_LINEAR);
+	if (!strcmp(wakeupname, "random"))
+		return (WAKEUP_RANDOM);
+
+	error("unsupported wake-up model");
+
+	/* Never gets here. */
+	return (WAKEUP_LINEAR);
+}
+
+/**
+ * @brief Gets jitter model.
+ *
+ * @param jittername Jitter model name.
+ *
+ * @returns Jitter model.
+ */
+static enum jitter_model get_jitter(const char *jittername)
+{
+	if (!strcmp(jittername, "periodic"))
+		return (JITTER_PERIODIC);
+	if (!strcmp(jittername, "random"))
+		return (JITTER_RANDOM);
+
+	error("unsupported jitter model");
+
+	/* Never gets here. */
+	return (JITTER_NONE);
+}
+
+/**
+ * @brief Gets time-slicing policy.
+ *
+ * @param policyname Time-slicing policy name.
+ *
+ * @returns Time-slicing policy.
+ */
+static enum timeslice_policy get_timeslice(const char *policyname)
+{
+	if (!strcmp(policyname, "rr"))
+		return (TIMESLICE_RR);
+	if (!strcmp(policyname, "cfs"))
+		return (TIMESLICE_CFS);
+
+	error("unsupported time-slicing policy");
+
+	/* Never gets here. */
+	return (TIMESLICE_RR);
+}
+
+/**
+ * @brief Gets tail scheduling scheme.
+ *
+ * @param tailname Tail scheduler name.
+ *
+ * @returns Tail scheduling scheme.
+ */
+static enum hybrid_tail get_tail(const char *tailname)
+{
+	if (!strcmp(tailname, "dynamic"))
+		return (HYBRID_TAIL_DYNAMIC);
+	if (!strcmp(tailname, "guided"))
+		return (HYBRID_TAIL_GUIDED);
+
+	error("unsupported tail scheduler");
+
+	/* Never gets here. */
+	return (-1);
+}
+
+/**
+ * @brief Gets loop scheduling strategy.
+ *
+ * @param schedname Loop scheduling strategy name.
+ *
+ * @returns Loop scheduling strategy.
+ */
+static const struct scheduler *get_scheduler(const char *schedname)
+{
+	if (!strcmp(schedname, "guided"))
+		return (sched_guided);
+	if (!strcmp(schedname, "wguided"))
+		return (sched_wguided);
+	if (!strcmp(schedname, "dynamic"))
+		return (sched_dynamic);
+	if (!strcmp(schedname, "lpt"))
+		return (sched_lpt);
+	if (!strcmp(schedname, "hss"))
+		return (sched_hss);
+	if (!strcmp(schedname, "kass"))
+		return (sched_kass);
+	if (!strcmp(schedname, "binlpt"))
+		return (sched_binlpt);
+	if (!strcmp(schedname, "hbinlpt"))
+		return (sched_hbinlpt);
+	if (!strcmp(schedname, "srr"))
+		return (sched_srr);
+	if (!strcmp(schedname, "static"))
+		return (sched_static);
+	if (!strcmp(schedname, "ccp"))
+		return (sched_ccp);
+	if (!strcmp(schedname, "hybrid"))
+		return (sched_hybrid);
+	if (!strcmp(schedname, "oracle"))
+		return (sched_oracle);
+	if (!strcmp(schedname, "auto"))
+		return (sched_auto);
+
+	error("unsupported loop scheduling strategy");
+
+	/* Never gets here. */
+	return (NULL);
+}
+
 /**
  * @brief Gets application kernel.
  *
@@ -240,6 +870,52 @@ static void checkargs(const char *wfilename, const char *afilename, const char *
 		error("missing number of working threads");
 	if (args.scheduler == NULL)
 		error("missing loop scheduling strategy");
+	if ((hybrid_fraction < 0.0) || (hybrid_fraction > 1.0))
+		error("invalid static fraction");
+	if (args.noise < 0.0)
+		error("invalid estimation noise");
+	if (args.nsteps < 1)
+		error("invalid number of time steps");
+	if (args.drift < 0.0)
+		error("invalid workload drift");
+	if (args.replan < 0)
+		error("invalid replanning period");
+	if (binlpt_tolerance < 0.0)
+		error("invalid repair tolerance");
+	if ((overhead_dispatch < 0.0) || (overhead_contention < 0.0) || (overhead_plan < 0.0))
+		error("invalid overhead");
+	if ((forkjoin_skew < 0.0) || (forkjoin_barrier < 0.0))
+		error("invalid fork-join cost");
+	if (bandwidth_intensity < 0.0)
+		error("invalid memory intensity");
+	if (locality_footprint < 0)
+		error("invalid task footprint");
+	if ((locality_warm <= 0.0) || (locality_warm > 1.0))
+		error("invalid cost of cached tasks");
+	if ((locality_reuse <= 0.0) || (locality_reuse > 1.0))
+		error("invalid cost of reused tasks");
+	if ((jitter_model != JITTER_NONE) && ((jitter_interval <= 0.0) || (jitter_length <= 0.0)))
+		error("invalid jitter");
+	if ((jitter_model == JITTER_PERIODIC) && (jitter_length >= jitter_interval))
+		error("invalid jitter");
+	if ((timeslice_quantum <= 0.0) || (timeslice_switch < 0.0))
+		error("invalid time slicing");
+	if (elastic_cost < 0.0)
+		error("invalid redistribution cost");
+	if ((hierarchy_nnodes < 1) || (hierarchy_nnodes > nthreads))
+		error("invalid number of nodes");
+	if ((hierarchy_nnodes > 1) && (args.outer == NULL))
+		error("missing outer loop scheduling strategy");
+	if ((hierarchy_latency < 0.0) || (args.outerchunk < 0))
+		error("invalid hierarchy");
+	if ((args.outer != NULL) && (args.nsteps > 1))
+		error("time steps unsupported across nodes");
+	if ((background_on < 0.0) || (background_off < 0.0))
+		error("invalid background process");
+	if ((background_on > 0.0) != (background_off > 0.0))
+		error("invalid background process");
+	if ((background_share <= 0.0) || (background_share > 1.0))
+		error("invalid background process");
 }
 
 /**
@@ -253,42 +929,112 @@ static void readargs(int argc, const char **argv)
 	const char *wfilename = NULL;
 	const char *afilename = NULL;
 	const char *kernelname = NULL;
+	const char *sfilename = NULL;
+	const char *ofilename = NULL;
+	const char *efilename = NULL;
+	const char *bfilename = NULL;
 	int nthreads = 0;
 
 	/* Parse command line arguments. */
 	for (int i = 1; i < argc; i++)
 	{	
-		if (!strcmp(argv[i], "--arch"))
+		if (!strcmp(argv[i], "--affinity"))
+			locality_persist = true;
+		else if (!strcmp(argv[i], "--arch"))
 			afilename = argv[++i];
+		else if (!strcmp(argv[i], "--background"))
+			bfilename = argv[++i];
+		else if (!strcmp(argv[i], "--barrier"))
+			forkjoin_barrier = atof(argv[++i]);
+		else if (!strcmp(argv[i], "--bgoff"))
+			background_off = atof(argv[++i]);
+		else if (!strcmp(argv[i], "--bgon"))
+			background_on = atof(argv[++i]);
+		else if (!strcmp(argv[i], "--bgshare"))
+			background_share = atof(argv[++i]);
 		else if (!strcmp(argv[i], "--chunksize"))
 			args.chunksize = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "--contention"))
+			overhead_contention = atof(argv[++i]);
+		else if (!strcmp(argv[i], "--drift"))
+			args.drift = atof(argv[++i]);
+		else if (!strcmp(argv[i], "--elastic"))
+			efilename = argv[++i];
+		else if (!strcmp(argv[i], "--footprint"))
+			locality_footprint = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "--fraction"))
+			hybrid_fraction = atof(argv[++i]);
 		else if (!strcmp(argv[i], "--input"))
 			wfilename = argv[++i];
+		else if (!strcmp(argv[i], "--intensity"))
+			bandwidth_intensity = atof(argv[++i]);
+		else if (!strcmp(argv[i], "--interval"))
+			jitter_interval = atof(argv[++i]);
+		else if (!strcmp(argv[i], "--jitter"))
+			jitter_model = get_jitter(argv[++i]);
 		else if (!strcmp(argv[i], "--kernel"))
 			kernelname = argv[++i];
+		else if (!strcmp(argv[i], "--latency"))
+			hierarchy_latency = atof(argv[++i]);
+		else if (!strcmp(argv[i], "--nodes"))
+			hierarchy_nnodes = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "--noise"))
+			args.noise = atof(argv[++i]);
+		else if (!strcmp(argv[i], "--nsteps"))
+			args.nsteps = atoi(argv[++i]);
 		else if (!strcmp(argv[i], "--nthreads"))
 			nthreads = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "--oracle"))
+			args.oracle = true;
+		else if (!strcmp(argv[i], "--outer"))
+			args.outer = get_scheduler(argv[++i]);
+		else if (!strcmp(argv[i], "--outerchunk"))
+			args.outerchunk = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "--overhead"))
+			overhead_dispatch = atof(argv[++i]);
+		else if (!strcmp(argv[i], "--pin"))
+			locality_pin = true;
+		else if (!strcmp(argv[i], "--plancost"))
+			overhead_plan = atof(argv[++i]);
+		else if (!strcmp(argv[i], "--quantum"))
+			timeslice_quantum = atof(argv[++i]);
+		else if (!strcmp(argv[i], "--redistcost"))
+			elastic_cost = atof(argv[++i]);
+		else if (!strcmp(argv[i], "--redistribute"))
+			elastic_policy = get_redistribute(argv[++i]);
+		else if (!strcmp(argv[i], "--repair"))
+		{
+			binlpt_incremental = true;
+			binlpt_tolerance = atof(argv[++i]);
+		}
+		else if (!strcmp(argv[i], "--replan"))
+			args.replan = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "--reuse"))
+			locality_reuse = atof(argv[++i]);
+		else if (!strcmp(argv[i], "--rules"))
+			auto_rules = argv[++i];
+		else if (!strcmp(argv[i], "--skew"))
+			forkjoin_skew = atof(argv[++i]);
+		else if (!strcmp(argv[i], "--speed"))
+			sfilename = argv[++i];
+		else if (!strcmp(argv[i], "--stall"))
+			jitter_length = atof(argv[++i]);
+		else if (!strcmp(argv[i], "--starts"))
+			ofilename = argv[++i];
+		else if (!strcmp(argv[i], "--switch"))
+			timeslice_switch = atof(argv[++i]);
+		else if (!strcmp(argv[i], "--tail"))
+			hybrid_tail = get_tail(argv[++i]);
+		else if (!strcmp(argv[i], "--timeslice"))
+			timeslice_policy = get_timeslice(argv[++i]);
+		else if (!strcmp(argv[i], "--wakeup"))
+			forkjoin_wakeup = get_wakeup(argv[++i]);
+		else if (!strcmp(argv[i], "--warm"))
+			locality_warm = atof(argv[++i]);
 		else if (!strcmp(argv[i], "--help"))
 			usage();
 		else
-		{
-			if (!strcmp(argv[i], "guided"))
-				args.scheduler = sched_guided;
-			else if (!strcmp(argv[i], "dynamic"))
-				args.scheduler = sched_dynamic;
-			else if (!strcmp(argv[i], "hss"))
-				args.scheduler = sched_hss;
-			else if (!strcmp(argv[i], "kass"))
-				args.scheduler = sched_kass;
-			else if (!strcmp(argv[i], "binlpt"))
-				args.scheduler = sched_binlpt;
-			else if (!strcmp(argv[i], "srr"))
-				args.scheduler = sched_srr;
-			else if (!strcmp(argv[i], "static"))
-				args.scheduler = sched_static;
-			else
-				error("unsupported loop scheduling strategy");
-		}
+			args.scheduler = get_scheduler(argv[i]);
 	}
 
 	checkargs(wfilename, afilename, kernelname, nthreads);
@@ -296,24 +1042,163 @@ static void readargs(int argc, const char **argv)
 	args.workload = get_workload(wfilename);
 	args.threads = get_threads(afilename, nthreads);
 	args.kernel = get_kernel(kernelname);
+	if (sfilename != NULL)
+		get_speed(sfilename, args.threads);
+	if (ofilename != NULL)
+		get_starts(ofilename, args.threads);
+	if (efilename != NULL)
+	{
+		if (args.outer != NULL)
+			error("elastic threads unsupported across nodes");
+		get_elastic(efilename, args.threads);
+	}
+	if (bfilename != NULL)
+		get_background(bfilename);
+	args.traces = (sfilename != NULL) || (ofilename != NULL) ||
+		(efilename != NULL) || (bfilename != NULL);
+
+	/* Task classes must be in the speed matrix. */
+	check_classes(args.workload);
 }
 
 /*============================================================================*
  * LOOP SCHEDULER SIMULATOR                                                   *
  *============================================================================*/
 
+/**
+ * @brief Computes the optimal makespan.
+ *
+ * @returns The makespan of a clairvoyant plan.
+ */
+static double optimal_makespan(void)
+{
+	double opt;         /* Optimal makespan. */
+	workload_tt actual; /* Actual workload.  */
+
+	actual = workload_reveal(args.workload);
+	opt = oracle_makespan(actual, args.threads);
+	workload_destroy(actual);
+
+	return (opt);
+}
+
+/**
+ * @brief Asserts if only the base cost model is enabled.
+ *
+ * @details The oracle only accounts for the actual cost of tasks and
+ * the capacities of threads.
+ *
+ * @returns True if no other cost model is enabled, and false otherwise.
+ */
+static bool base_model(void)
+{
+	return ((!args.traces) && (args.outer == NULL) &&
+		(overhead_dispatch == 0.0) && (overhead_contention == 0.0) &&
+		(overhead_plan == 0.0) && (forkjoin_barrier == 0.0) &&
+		(forkjoin_skew == 0.0) && (jitter_model == JITTER_NONE) &&
+		(background_on == 0.0) && (speed_matrix == NULL) &&
+		((numa_nnodes == 1) || (numa_remote == 1.0)) &&
+		((locality_footprint == 0) || (locality_cache == 0)) &&
+		(bandwidth_limit == 0.0) && (smt_corun == 1.0) &&
+		(array_size(args.threads) <= timeslice_ncpus));
+}
+
+/**
+ * @brief Prints the optimality gap.
+ *
+ * @details The gap is only reported under the base cost model, as the
+ * oracle ignores the other ones.
+ *
+ * @param makespan Simulated makespan.
+ * @param opt      Makespan of the oracle.
+ */
+static void print_gap(double makespan, double opt)
+{
+	printf("oracle: %lf\n", opt);
+	if (base_model())
+		printf("gap: %lf\n", makespan/opt - 1.0);
+	else
+		printf("gap: n/a (cost models beyond the oracle)\n");
+}
+
+/**
+ * @brief Simulates several time steps of a parallel loop.
+ *
+ * @returns The cumulative makespan.
+ */
+static double simsched_steps(void)
+{
+	double makespan = 0.0; /* Cumulative makespan. */
+	double opt = 0.0;      /* Cumulative optimal.  */
+	int nreplans = 0;      /* Number of replans.   */
+
+	for (int k = 0; k < args.nsteps; k++)
+	{
+		bool replan; /* Replan at this step? */
+		double t;    /* Makespan of the step. */
+
+		if (k > 0)
+			next_workload(args.workload);
+
+		replan = (k == 0) || ((args.replan > 0) && (k%args.replan == 0));
+		nreplans += replan;
+
+		t = simshed_step(args.workload, args.threads, args.scheduler, args.chunksize, replan);
+		makespan += t;
+
+		printf("step %d: %lf\n", k, t);
+
+		if (args.oracle)
+			opt += optimal_makespan();
+	}
+
+	simshed_end(args.scheduler);
+
+	printf("nchunks: %d\n", nchunks);
+	printf("replans: %d\n", nreplans);
+	printf("time: %lf\n", makespan);
+
+	/* Optimality gap. */
+	if (args.oracle)
+		print_gap(makespan, opt);
+
+	return (makespan);
+}
+
 /**
  * @brief A loop scheduler simulator
  */
 int main(int argc, const char **argv)
 {
+	double makespan; /* Simulated makespan. */
+
 	readargs(argc, argv);
 
 	args.kernel(args.workload);
 
 	srand(time(NULL)^getpid());
 
-	simshed(args.workload, args.threads, args.scheduler, args.chunksize);
+	workload_perturb(args.workload, args.noise);
+
+	/* Multiple time steps. */
+	if (args.nsteps > 1)
+		simsched_steps();
+
+	else
+	{
+		/* Multiple nodes. */
+		if (args.outer != NULL)
+		{
+			makespan = simshed_hierarchical(args.workload, args.threads, args.outer, args.scheduler,
+				(args.outerchunk > 0) ? args.outerchunk : args.chunksize, args.chunksize);
+		}
+		else
+			makespan = simshed(args.workload, args.threads, args.scheduler, args.chunksize);
+
+		/* Optimality gap. */
+		if (args.oracle)
+			print_gap(makespan, optimal_makespan());
+	}
 
 	/* House keeping, */
 	for (int i = 0; i < array_size(args.threads); i++)
@@ -323,6 +1208,9 @@ int main(int argc, const char **argv)
 	}
 	array_destroy(args.threads);
 	workload_destroy(args.workload);
+	fclose(args.input);
+	if (speed_matrix != NULL)
+		free(speed_matrix);
 
 	return (EXIT_SUCCESS);
 }
@@ -0,0 +1,828 @@
+/*
+ * Copyright(C) 2016 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ * 
+ * This file is part of Scheduler.
+ *
+ * Scheduler is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ * 
+ * Scheduler is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Scheduler; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include <mylib/util.h>
+#include <mylib/dqueue.h>
+#include <mylib/heap.h>
+#include <mylib/queue.h>
+
+#include <scheduler.h>
+
+/**
+ * @brief Maximum work for Karmarkar-Karp differencing (tasks x threads).
+ */
+#define ORACLE_KK_BUDGET (1 << 24)
+
+/**
+ * @brief Maximum number of local search iterations.
+ */
+#define ORACLE_LS_NITERATIONS 1024
+
+/**
+ * @brief Oracle scheduler data.
+ */
+static struct
+{
+	const_workload_tt workload; /**< Workload.          */
+	array_tt threads;           /**< Threads.           */
+	thread_tt *taskmap;         /**< Scheduling.        */
+	bool *served;               /**< Shares handed out. */
+} scheddata = { NULL, NULL, NULL, NULL };
+
+/*============================================================================*
+ * THREADS                                                                    *
+ *============================================================================*/
+
+/**
+ * @brief Thread capacity class.
+ */
+struct oracle_class
+{
+	double capacity; /**< Processing capacity. */
+	int tidx;        /**< Thread index.        */
+};
+
+/**
+ * @brief Compares two thread capacity classes.
+ */
+static int oracle_class_cmp(const void *a, const void *b)
+{
+	const struct oracle_class *c1 = a;
+	const struct oracle_class *c2 = b;
+
+	if (c1->capacity != c2->capacity)
+		return ((c1->capacity < c2->capacity) ? -1 : 1);
+
+	return (c1->tidx - c2->tidx);
+}
+
+/**
+ * @brief Sorts threads by processing capacity.
+ *
+ * @param capacity Processing capacity of threads.
+ * @param nthreads Number of threads.
+ *
+ * @returns Thread indexes, fastest threads first.
+ */
+static int *oracle_sort_threads(const double *capacity, int nthreads)
+{
+	int *order;                   /* Sorted threads. */
+	struct oracle_class *classes; /* Thread classes. */
+
+	classes = smalloc(nthreads*sizeof(struct oracle_class));
+	order = smalloc(nthreads*sizeof(int));
+
+	for (int i = 0; i < nthreads; i++)
+	{
+		classes[i].capacity = capacity[i];
+		classes[i].tidx = i;
+	}
+
+	qsort(classes, nthreads, sizeof(struct oracle_class), oracle_class_cmp);
+
+	for (int i = 0; i < nthreads; i++)
+		order[i] = classes[i].tidx;
+
+	/* House keeping. */
+	free(classes);
+
+	return (order);
+}
+
+/**
+ * @brief Computes the makespan of a plan.
+ *
+ * @param load     Workload assigned to threads.
+ * @param capacity Processing capacity of threads.
+ * @param nthreads Number of threads.
+ *
+ * @returns The makespan of the plan.
+ */
+static double oracle_plan_makespan(const double *load, const double *capacity, int nthreads)
+{
+	double makespan = 0.0;
+
+	for (int i = 0; i < nthreads; i++)
+	{
+		if (makespan < load[i]*capacity[i])
+			makespan = load[i]*capacity[i];
+	}
+
+	return (makespan);
+}
+
+/*============================================================================*
+ * LONGEST PROCESSING TIME FIRST                                              *
+ *============================================================================*/
+
+/**
+ * @brief Assigns tasks in descending order to the thread that finishes first.
+ *
+ * @param w        Target workload.
+ * @param map      Task sorting map (ascending).
+ * @param first    Number of largest tasks to skip.
+ * @param capacity Processing capacity of threads.
+ * @param nthreads Number of threads.
+ * @param plan     Task assignment (output).
+ * @param load     Workload assigned to threads (input/output).
+ */
+static void oracle_lpt(const_workload_tt w, const int *map, int first, const double *capacity, int nthreads, int *plan, double *load)
+{
+	int ntasks;     /* Number of tasks.                */
+	int nheaps;     /* Number of thread heaps.         */
+	int *order;     /* Threads sorted by capacity.     */
+	heap_tt *heaps; /* Thread heaps, one per capacity. */
+	double *heapcap; /* Capacity of thread heaps.      */
+
+	ntasks = workload_ntasks(w);
+	order = oracle_sort_threads(capacity, nthreads);
+	heaps = smalloc(nthreads*sizeof(heap_tt));
+	heapcap = smalloc(nthreads*sizeof(double));
+
+	/* Build thread heaps. */
+	nheaps = 0;
+	for (int i = 0; i < nthreads; i++)
+	{
+		if ((i == 0) || (capacity[order[i]] != heapcap[nheaps - 1]))
+		{
+			heapcap[nheaps] = capacity[order[i]];
+			heaps[nheaps++] = heap_create(nthreads);
+		}
+
+		heap_insert(heaps[nheaps - 1], &order[i], load[order[i]]);
+	}
+
+	/* Assign tasks to threads. */
+	for (int i = first; i < ntasks; i++)
+	{
+		int h;    /* Heap of target thread. */
+		int k;    /* Target task.           */
+		int tidx; /* Target thread.         */
+
+		k = map[ntasks - i - 1];
+
+		/* Search for thread that finishes first. */
+		h = 0;
+		for (int j = 1; j < nheaps; j++)
+		{
+			double f1 = (heap_min(heaps[j]) + workload_task(w, k))*heapcap[j];
+			double f2 = (heap_min(heaps[h]) + workload_task(w, k))*heapcap[h];
+
+			if (f1 < f2)
+				h = j;
+		}
+
+		tidx = *((int *) heap_top(heaps[h]));
+		plan[k] = tidx;
+		load[tidx] += workload_task(w, k);
+		heap_insert(heaps[h], heap_remove(heaps[h]), load[tidx]);
+	}
+
+	/* House keeping. */
+	for (int i = 0; i < nheaps; i++)
+		heap_destroy(heaps[i]);
+	free(heapcap);
+	free(heaps);
+	free(order);
+}
+
+/*============================================================================*
+ * KARMARKAR-KARP DIFFERENCING                                                *
+ *============================================================================*/
+
+/**
+ * @brief Subset of a partial partition.
+ */
+struct kk_subset
+{
+	double sum; /**< Sum of weights. */
+	int head;   /**< First task.     */
+	int tail;   /**< Last task.      */
+};
+
+/**
+ * @brief Partial partition.
+ */
+struct kk_tuple
+{
+	int n;                     /**< Number of non-empty subsets.      */
+	struct kk_subset *subsets; /**< Non-empty subsets, largest first. */
+};
+
+/**
+ * @brief Compares two subsets in descending order of weight.
+ */
+static int kk_subset_cmp(const void *a, const void *b)
+{
+	const struct kk_subset *s1 = a;
+	const struct kk_subset *s2 = b;
+
+	if (s1->sum != s2->sum)
+		return ((s1->sum > s2->sum) ? -1 : 1);
+
+	return (0);
+}
+
+/**
+ * @brief Computes the spread of a partial partition.
+ *
+ * @param t Target partial partition.
+ * @param m Number of subsets.
+ *
+ * @returns The difference between the largest and smallest subsets.
+ */
+static double kk_spread(const struct kk_tuple *t, int m)
+{
+	return (t->subsets[0].sum - ((t->n < m) ? 0.0 : t->subsets[m - 1].sum));
+}
+
+/**
+ * @brief Combines two partial partitions.
+ *
+ * @details The largest subset of a is joined with the smallest subset of
+ * b, the second largest with the second smallest, and so on.
+ *
+ * @param a    Target partial partition (output).
+ * @param b    Partial partition to merge into a.
+ * @param m    Number of subsets.
+ * @param next Next task in subset lists.
+ */
+static void kk_combine(struct kk_tuple *a, struct kk_tuple *b, int m, int *next)
+{
+	int n;                 /* Number of subsets.    */
+	struct kk_subset *out; /* Resulting partitions. */
+
+	n = ((a->n + b->n) < m) ? a->n + b->n : m;
+	out = smalloc(n*sizeof(struct kk_subset));
+
+	/* Disjoint subsets. */
+	if ((a->n + b->n) <= m)
+	{
+		memcpy(out, a->subsets, a->n*sizeof(struct kk_subset));
+		memcpy(&out[a->n], b->subsets, b->n*sizeof(struct kk_subset));
+	}
+
+	/* Join subsets. */
+	else
+	{
+		for (int i = 0; i < m; i++)
+		{
+			const struct kk_subset *sa, *sb;
+
+			sa = (i < a->n) ? &a->subsets[i] : NULL;
+			sb = (i >= (m - b->n)) ? &b->subsets[m - i - 1] : NULL;
+
+			if (sa == NULL)
+				out[i] = *sb;
+			else if (sb == NULL)
+				out[i] = *sa;
+			else
+			{
+				out[i].sum = sa->sum + sb->sum;
+				out[i].head = sa->head;
+				out[i].tail = sb->tail;
+				next[sa->tail] = sb->head;
+			}
+		}
+	}
+
+	qsort(out, n, sizeof(struct kk_subset), kk_subset_cmp);
+
+	/* House keeping. */
+	free(a->subsets);
+	free(b->subsets);
+	b->subsets = NULL;
+	a->subsets = out;
+	a->n = n;
+}
+
+/**
+ * @brief Partitions the largest tasks using Karmarkar-Karp differencing.
+ *
+ * @param w        Target workload.
+ * @param map      Task sorting map (ascending).
+ * @param nkk      Number of largest tasks to partition.
+ * @param capacity Processing capacity of threads.
+ * @param nthreads Number of threads.
+ * @param plan     Task assignment (output).
+ * @param load     Workload assigned to threads (output).
+ */
+static void oracle_kk(const_workload_tt w, const int *map, int nkk, const double *capacity, int nthreads, int *plan, double *load)
+{
+	int ntasks;              /* Number of tasks.            */
+	int *next;               /* Next task in subset lists.  */
+	int *order;              /* Threads sorted by capacity. */
+	heap_tt heap;            /* Partial partitions.         */
+	struct kk_tuple *tuples; /* Partial partitions.         */
+	struct kk_tuple *t;      /* Final partition.            */
+
+	ntasks = workload_ntasks(w);
+	next = smalloc(ntasks*sizeof(int));
+	tuples = smalloc(nkk*sizeof(struct kk_tuple));
+	heap = heap_create(nkk);
+
+	/* One partial partition per task. */
+	for (int i = 0; i < nkk; i++)
+	{
+		int k = map[ntasks - i - 1];
+
+		next[k] = -1;
+		tuples[i].n = 1;
+		tuples[i].subsets = smalloc(sizeof(struct kk_subset));
+		tuples[i].subsets[0].sum = workload_task(w, k);
+		tuples[i].subsets[0].head = k;
+		tuples[i].subsets[0].tail = k;
+		heap_insert(heap, &tuples[i], -kk_spread(&tuples[i], nthreads));
+	}
+
+	/* Differencing. */
+	while (heap_size(heap) > 1)
+	{
+		struct kk_tuple *a = heap_remove(heap);
+		struct kk_tuple *b = heap_remove(heap);
+
+		kk_combine(a, b, nthreads, next);
+		heap_insert(heap, a, -kk_spread(a, nthreads));
+	}
+
+	/* Largest subsets go to fastest threads. */
+	t = heap_remove(heap);
+	order = oracle_sort_threads(capacity, nthreads);
+	for (int i = 0; i < t->n; i++)
+	{
+		for (int k = t->subsets[i].head; k >= 0; k = next[k])
+			plan[k] = order[i];
+		load[order[i]] += t->subsets[i].sum;
+	}
+
+	/* House keeping. */
+	free(order);
+	free(t->subsets);
+	heap_destroy(heap);
+	free(tuples);
+	free(next);
+}
+
+/*============================================================================*
+ * LOCAL SEARCH                                                               *
+ *============================================================================*/
+
+/**
+ * @brief Compares two task weights.
+ */
+static int oracle_weight_cmp(const void *a, const void *b)
+{
+	return (*((const int *) a) - *((const int *) b));
+}
+
+/**
+ * @brief Collects the tasks assigned to a thread.
+ *
+ * @param head  First task of each thread.
+ * @param next  Next task in thread lists.
+ * @param tidx  Target thread.
+ * @param tasks Tasks (output).
+ *
+ * @returns The number of tasks assigned to the target thread.
+ */
+static int oracle_collect(const int *head, const int *next, int tidx, int *tasks)
+{
+	int n = 0;
+
+	for (int k = head[tidx]; k >= 0; k = next[k])
+		tasks[n++] = k;
+
+	return (n);
+}
+
+/**
+ * @brief Moves a task between threads.
+ *
+ * @param w    Target workload.
+ * @param head First task of each thread.
+ * @param next Next task in thread lists.
+ * @param prev Previous task in thread lists.
+ * @param plan Task assignment.
+ * @param load Workload assigned to threads.
+ * @param k    Target task.
+ * @param to   Target thread.
+ */
+static void oracle_move(const_workload_tt w, int *head, int *next, int *prev, int *plan, double *load, int k, int to)
+{
+	int from = plan[k];
+
+	/* Unlink. */
+	if (prev[k] >= 0)
+		next[prev[k]] = next[k];
+	else
+		head[from] = next[k];
+	if (next[k] >= 0)
+		prev[next[k]] = prev[k];
+
+	/* Link. */
+	prev[k] = -1;
+	next[k] = head[to];
+	if (head[to] >= 0)
+		prev[head[to]] = k;
+	head[to] = k;
+
+	plan[k] = to;
+	load[from] -= workload_task(w, k);
+	load[to] += workload_task(w, k);
+}
+
+/**
+ * @brief Improves a plan by moving and swapping tasks.
+ *
+ * @details At each step, tasks are exchanged between the thread that
+ * finishes last and the thread that finishes first.
+ *
+ * @param w        Target workload.
+ * @param capacity Processing capacity of threads.
+ * @param nthreads Number of threads.
+ * @param plan     Task assignment (input/output).
+ * @param load     Workload assigned to threads (input/output).
+ */
+static void oracle_local_search(const_workload_tt w, const double *capacity, int nthreads, int *plan, double *load)
+{
+	int ntasks;       /* Number of tasks.           */
+	int *head;        /* First task of each thread. */
+	int *next, *prev; /* Thread lists.              */
+	int *tb, *tj;     /* Tasks of two threads.      */
+
+	ntasks = workload_ntasks(w);
+	head = smalloc(nthreads*sizeof(int));
+	next = smalloc(ntasks*sizeof(int));
+	prev = smalloc(ntasks*sizeof(int));
+	tb = smalloc(ntasks*sizeof(int));
+	tj = smalloc(ntasks*sizeof(int));
+
+	/* Build thread lists. */
+	for (int i = 0; i < nthreads; i++)
+		head[i] = -1;
+	for (int k = ntasks - 1; k >= 0; k--)
+	{
+		prev[k] = -1;
+		next[k] = head[plan[k]];
+		if (head[plan[k]] >= 0)
+			prev[head[plan[k]]] = k;
+		head[plan[k]] = k;
+	}
+
+	for (int it = 0; it < ORACLE_LS_NITERATIONS; it++)
+	{
+		int b, j;      /* Last and first threads.     */
+		int nb, nj;    /* Number of tasks.            */
+		int kb, kj;    /* Best move or swap.          */
+		double fb, fj; /* Finish times.               */
+		double best;   /* Best resulting makespan.    */
+		double target; /* Ideal amount of work moved. */
+
+		/* Last and first threads. */
+		b = j = 0;
+		for (int i = 1; i < nthreads; i++)
+		{
+			if (load[i]*capacity[i] > load[b]*capacity[b])
+				b = i;
+			if (load[i]*capacity[i] < load[j]*capacity[j])
+				j = i;
+		}
+		fb = load[b]*capacity[b];
+		fj = load[j]*capacity[j];
+		target = (fb - fj)/(capacity[b] + capacity[j]);
+		best = fb;
+		kb = kj = -1;
+
+		/* Best move. */
+		for (int k = head[b]; k >= 0; k = next[k])
+		{
+			int x = workload_task(w, k);
+			double f1 = (load[b] - x)*capacity[b];
+			double f2 = (load[j] + x)*capacity[j];
+			double f = (f1 > f2) ? f1 : f2;
+
+			if (f < best)
+			{
+				best = f;
+				kb = k;
+			}
+		}
+
+		/* Best swap. */
+		if (kb < 0)
+		{
+			nb = oracle_collect(head, next, b, tb);
+			nj = oracle_collect(head, next, j, tj);
+			for (int i = 0; i < nb; i++)
+				tb[i] = workload_task(w, tb[i]);
+			for (int i = 0; i < nj; i++)
+				tj[i] = workload_task(w, tj[i]);
+			qsort(tb, nb, sizeof(int), oracle_weight_cmp);
+			qsort(tj, nj, sizeof(int), oracle_weight_cmp);
+
+			for (int i = 0; i < nb; i++)
+			{
+				int lo, hi;
+
+				/* Skip repeated weights. */
+				if ((i > 0) && (tb[i] == tb[i - 1]))
+					continue;
+
+				/* Smallest task in j that is not below x - target. */
+				lo = 0; hi = nj;
+				while (lo < hi)
+				{
+					int mid = lo + (hi - lo)/2;
+
+					if (tj[mid] < tb[i] - target)
+						lo = mid + 1;
+					else
+						hi = mid;
+				}
+
+				/* Check neighbours. */
+				for (int l = lo - 1; l <= lo; l++)
+				{
+					int d;
+					double f, f1, f2;
+
+					if ((l < 0) || (l >= nj) || (tj[l] >= tb[i]))
+						continue;
+
+					d = tb[i] - tj[l];
+					f1 = (load[b] - d)*capacity[b];
+					f2 = (load[j] + d)*capacity[j];
+					f = (f1 > f2) ? f1 : f2;
+
+					if (f < best)
+					{
+						best = f;
+						kb = tb[i];
+						kj = tj[l];
+					}
+				}
+			}
+
+			/* Translate weights back to tasks. */
+			if (kb >= 0)
+			{
+				int x = kb, y = kj;
+
+				for (kb = head[b]; workload_task(w, kb) != x; kb = next[kb])
+					/* noop */ ;
+				for (kj = head[j]; workload_task(w, kj) != y; kj = next[kj])
+					/* noop */ ;
+			}
+		}
+
+		/* Local optimum. */
+		if (kb < 0)
+			break;
+
+		oracle_move(w, head, next, prev, plan, load, kb, j);
+		if (kj >= 0)
+			oracle_move(w, head, next, prev, plan, load, kj, b);
+	}
+
+	/* House keeping. */
+	free(tj);
+	free(tb);
+	free(prev);
+	free(next);
+	free(head);
+}
+
+/*============================================================================*
+ * ORACLE                                                                     *
+ *============================================================================*/
+
+/**
+ * @brief Computes a near-optimal task assignment.
+ *
+ * @details The best of LPT and Karmarkar-Karp differencing is refined
+ * with local search. Differencing costs O(n*p) so, on large inputs, it
+ * is applied to the largest tasks only and LPT places the remaining ones.
+ *
+ * @param w       Target workload.
+ * @param threads Target threads.
+ * @param plan    Task assignment (output), indexes into threads.
+ *
+ * @returns The makespan of the assignment.
+ */
+static double oracle_plan(const_workload_tt w, array_tt threads, int *plan)
+{
+	int ntasks;      /* Number of tasks.           */
+	int nthreads;    /* Number of threads.         */
+	int nkk;         /* Number of tasks for KK.    */
+	int *map;        /* Task sorting map.          */
+	double *capacity; /* Thread capacities.        */
+	int *plan2;      /* Alternative assignment.    */
+	double *load;    /* Load of threads.           */
+	double *load2;   /* Load of threads.           */
+	double makespan; /* Makespan.                  */
+
+	ntasks = workload_ntasks(w);
+	nthreads = array_size(threads);
+
+	map = workload_sortmap(w);
+	capacity = smalloc(nthreads*sizeof(double));
+	load = smalloc(nthreads*sizeof(double));
+	load2 = smalloc(nthreads*sizeof(double));
+	plan2 = smalloc(ntasks*sizeof(int));
+
+	for (int i = 0; i < nthreads; i++)
+	{
+		capacity[i] = thread_capacity(array_get(threads, i));
+		load[i] = load2[i] = 0.0;
+	}
+
+	/* Longest processing time first. */
+	oracle_lpt(w, map, 0, capacity, nthreads, plan, load);
+
+	/* Karmarkar-Karp differencing. */
+	nkk = ORACLE_KK_BUDGET/nthreads;
+	if (nkk > ntasks)
+		nkk = ntasks;
+	oracle_kk(w, map, nkk, capacity, nthreads, plan2, load2);
+	oracle_lpt(w, map, nkk, capacity, nthreads, plan2, load2);
+
+	/* Keep the best one. */
+	if (oracle_plan_makespan(load2, capacity, nthreads) < oracle_plan_makespan(load, capacity, nthreads))
+	{
+		memcpy(plan, plan2, ntasks*sizeof(int));
+		memcpy(load, load2, nthreads*sizeof(double));
+	}
+
+	oracle_local_search(w, capacity, nthreads, plan, load);
+
+	makespan = oracle_plan_makespan(load, capacity, nthreads);
+
+	/* House keeping. */
+	free(plan2);
+	free(load2);
+	free(load);
+	free(capacity);
+	free(map);
+
+	return (makespan);
+}
+
+/**
+ * @brief Computes a near-optimal makespan.
+ *
+ * @param w       Target workload.
+ * @param threads Target threads.
+ *
+ * @returns A near-optimal makespan for the target workload.
+ */
+double oracle_makespan(const_workload_tt w, array_tt threads)
+{
+	int *plan;
+	double makespan;
+
+	/* Sanity check. */
+	assert(w != NULL);
+	assert(threads != NULL);
+
+	plan = smalloc(workload_ntasks(w)*sizeof(int));
+	makespan = oracle_plan(w, threads, plan);
+	free(plan);
+
+	return (makespan);
+}
+
+/*============================================================================*
+ * ORACLE SCHEDULER                                                           *
+ *============================================================================*/
+
+/**
+ * @brief Initializes the oracle scheduler.
+ * 
+ * @param workload  Target workload.
+ * @param threads   Target threads.
+ * @param chunksize Chunk size.
+ *
+ * @returns The number of tasks planned.
+ */
+int scheduler_oracle_init(const_workload_tt workload, array_tt threads, int chunksize)
+{
+	int ntasks; /* Number of tasks. */
+	int *plan;  /* Task assignment. */
+
+	((void) chunksize);
+
+	/* Sanity check. */
+	assert(workload != NULL);
+	assert(threads != NULL);
+
+	/* Already initialized, so hand out shares again. */
+	if (scheddata.taskmap != NULL)
+	{
+		for (int j = 0; j < array_size(threads); j++)
+			scheddata.served[j] = false;
+		return (0);
+	}
+
+	ntasks = workload_ntasks(workload);
+
+	/* Initialize scheduler data. */
+	scheddata.workload = workload;
+	scheddata.threads = threads;
+	scheddata.taskmap = smalloc(ntasks*sizeof(thread_tt));
+	scheddata.served = smalloc(array_size(threads)*sizeof(bool));
+	for (int j = 0; j < array_size(threads); j++)
+		scheddata.served[j] = false;
+
+	plan = smalloc(ntasks*sizeof(int));
+	oracle_plan(workload, threads, plan);
+	for (int i = 0; i < ntasks; i++)
+		scheddata.taskmap[i] = array_get(threads, plan[i]);
+
+	/* House keeping. */
+	free(plan);
+
+	return (ntasks);
+}
+
+/**
+ * @brief Finalizes the oracle scheduler.
+ */
+void scheduler_oracle_end(void)
+{
+	free(scheddata.served);
+	free(scheddata.taskmap);
+	scheddata.taskmap = NULL;
+}
+
+/**
+ * @brief Oracle scheduler.
+ * 
+ * @param running Target queue of running threads.
+ * @param t       Target thread
+ * 
+ * @returns Number scheduled tasks,
+ */
+int scheduler_oracle_sched(dqueue_tt running, thread_tt t)
+{
+	int n = 0;     /* Number of tasks scheduled. */
+	int wsize = 0; /* Size of assigned work.     */
+	int tidx;      /* Thread index.              */
+
+	/* Share already handed out. */
+	tidx = thread_gettid(t)%array_size(scheddata.threads);
+	if (scheddata.served[tidx])
+		return (0);
+	scheddata.served[tidx] = true;
+
+	nchunks++;
+
+	/* Get next tasks. */
+	for (int i = 0; i < workload_ntasks(scheddata.workload); i++)
+	{
+		/* Skip tasks from other threads. */
+		if (scheddata.taskmap[i] != t)
+			continue;
+
+		n++;
+		wsize += thread_assign(t, scheddata.workload, i);
+	}
+	
+	dqueue_insert(running, t, wsize);
+
+	return (n);
+}
+
+/**
+ * @brief Oracle scheduler.
+ */
+static struct scheduler _sched_oracle = {
+	false,
+	scheduler_oracle_init,
+	scheduler_oracle_sched,
+	scheduler_oracle_end
+};
+
+const struct scheduler *sched_oracle = &_sched_oracle;
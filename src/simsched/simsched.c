@@ -28,6 +28,7 @@
 #include <mylib/util.h>
 #include <mylib/array.h>
 #include <mylib/dqueue.h>
+#include <mylib/heap.h>
 #include <mylib/queue.h>
 
 #include <scheduler.h>
@@ -39,35 +40,448 @@
  */
 int nchunks = 0;
 
+/**
+ * @brief Cost per dispatch.
+ */
+double overhead_dispatch = 0.0;
+
+/**
+ * @brief Cost per concurrent dispatch.
+ */
+double overhead_contention = 0.0;
+
+/**
+ * @brief Planning cost per task.
+ */
+double overhead_plan = 0.0;
+
+/**
+ * @brief Wake-up model of threads.
+ */
+enum wakeup_model forkjoin_wakeup = WAKEUP_LINEAR;
+
+/**
+ * @brief Mean delay between two thread wake-ups.
+ */
+double forkjoin_skew = 0.0;
+
+/**
+ * @brief Barrier cost per level of the reduction tree.
+ */
+double forkjoin_barrier = 0.0;
+
+/**
+ * @brief Number of hardware threads (zero for one per thread).
+ */
+int timeslice_ncpus = 0;
+
+/**
+ * @brief Time-slicing policy.
+ */
+enum timeslice_policy timeslice_policy = TIMESLICE_RR;
+
+/**
+ * @brief Time slice.
+ */
+double timeslice_quantum = 1000.0;
+
+/**
+ * @brief Context switch cost.
+ */
+double timeslice_switch = 0.0;
+
+/**
+ * @brief Redistribution policy for the work of absent threads.
+ */
+enum elastic_policy elastic_policy = ELASTIC_STEAL;
+
+/**
+ * @brief Cost per redistributed task.
+ */
+double elastic_cost = 0.0;
+
+/**
+ * @brief Number of nodes (hierarchical scheduling).
+ */
+int hierarchy_nnodes = 1;
+
+/**
+ * @brief Latency of a dispatch across nodes.
+ */
+double hierarchy_latency = 0.0;
+
 /**
  * @brief Ready threads.
  */
 static queue_tt ready;
 
 /**
- * @brief Running threads.
+ * @brief Running threads, keyed by finish time.
  */
-static dqueue_tt running;
+static heap_tt running;
+
+/**
+ * @brief Chunks handed out by the scheduling strategy.
+ */
+static dqueue_tt dispatched;
+
+/**
+ * @brief Dispatches in progress, keyed by end time.
+ */
+static heap_tt dispatching;
+
+/**
+ * @brief Current time.
+ */
+static double now = 0.0;
+
+/**
+ * @brief Total overhead.
+ */
+static double overhead = 0.0;
+
+/**
+ * @brief Time during which memory bandwidth was saturated.
+ */
+static double saturated = 0.0;
+
+/**
+ * @brief Time spent by threads running next to a busy sibling.
+ */
+static double corun = 0.0;
+
+/**
+ * @brief Time spent by threads running.
+ */
+static double busytime = 0.0;
+
+/**
+ * @brief Number of tasks scheduled.
+ */
+static int nscheduled = 0;
+
+/**
+ * @brief Number of context switches.
+ */
+static int nswitches = 0;
+
+/**
+ * @brief Chunk of work, possibly left unfinished by a thread that left.
+ *
+ * @details Workload and memory traffic are in units of work, before
+ * scaling by the capacity of the owner.
+ */
+struct chunk
+{
+	double work;     /**< Remaining work.             */
+	int ntasks;      /**< Remaining tasks (estimate). */
+	double capacity; /**< Capacity of its last owner. */
+	double wtotal;   /**< Remaining workload.         */
+	double wremote;  /**< Remaining remote workload.  */
+	double bytes;    /**< Remaining memory traffic.   */
+};
+
+/**
+ * @brief Elastic thread pool.
+ */
+static struct
+{
+	bool elastic;       /**< Do threads join or leave?       */
+	array_tt threads;   /**< Threads.                        */
+	int *adopter;       /**< Thread serving each absent one. */
+	queue_tt orphans;   /**< Work left by threads that left. */
+	double origin;      /**< Start of the loop.              */
+	int nredistributed; /**< Tasks run on behalf of others.  */
+} pool = { false, NULL, NULL, NULL, 0.0, 0 };
+
+/**
+ * @brief Hardware threads.
+ */
+static struct
+{
+	int ncpus;         /**< Number of hardware threads.       */
+	int *off;          /**< Offset to threads of each one.    */
+	int *tidx;         /**< Threads, by hardware thread.      */
+	int *cpu;          /**< Hardware thread of threads.       */
+	int *current;      /**< Thread last run on each one.      */
+	double *sliceend;  /**< End of current time slices.       */
+	double *switchend; /**< End of current context switches.  */
+	double *vruntime;  /**< Time spent by threads running.    */
+} cpus = { 0, NULL, NULL, NULL, NULL, NULL, NULL, NULL };
 
 /**
  * @brief Spawns threads.
  *
+ * @details Threads that are not pinned may land on other cores than
+ * in the previous loop instance.
+ *
  * @param threads Working threads.
  * @param pin     Pin threads?
  */
 static void threads_spawn(array_tt threads, bool pinthreads)
 {
 	ready = queue_create();	
-	running = dqueue_create();
+	running = heap_create(array_size(threads));
+	dispatched = dqueue_create();
+	dispatching = heap_create(array_size(threads));
 
 	if (!pinthreads)
 		array_shuffle(threads);
 
+	/* Migrate threads. */
+	if ((!pinthreads) && (locality_persist))
+	{
+		for (int i = array_size(threads) - 1; i > 0; i--)
+			thread_migrate(array_get(threads, i), array_get(threads, rand()%(i + 1)));
+	}
+}
+
+/**
+ * @brief Wakes up threads.
+ *
+ * @details Threads are woken up one after the other, either at a
+ * fixed delay from each other or at exponentially distributed delays
+ * of the same mean, unless their start offsets are given, but not
+ * before they arrive. Threads that are not yet awake are kept with the
+ * running ones, until they wake up.
+ *
+ * @param threads Working threads.
+ */
+static void threads_wakeup(array_tt threads)
+{
+	double wakeup = 0.0; /* Last wake-up. */
+
 	for (int i = 0; i < array_size(threads); i++)
+	{
+		double offset; /* Start offset. */
+		thread_tt t;   /* Thread.       */
+
+		t = array_get(threads, i);
+
+		/* Next wake-up. */
+		if (i > 0)
+		{
+			wakeup += (forkjoin_wakeup == WAKEUP_LINEAR) ?
+				forkjoin_skew : -forkjoin_skew*log(1.0 - rand()/(RAND_MAX + 1.0));
+		}
+
+		offset = thread_offset(t);
+		if (offset < 0.0)
+			offset = wakeup;
+
+		/* Late arrival. */
+		if (offset < thread_arrival(t))
+			offset = thread_arrival(t);
+
+		if (offset > 0.0)
+			heap_insert(running, t, now + offset);
+		else
+			queue_insert(ready, t);
+	}
+}
+
+/**
+ * @brief Asserts whether threads outnumber hardware threads.
+ *
+ * @param nthreads Number of threads.
+ *
+ * @returns True if threads must take turns, and false otherwise.
+ */
+static bool simsched_oversubscribed(int nthreads)
+{
+	return ((timeslice_ncpus > 0) && (nthreads > timeslice_ncpus));
+}
+
+/**
+ * @brief Sets up time slicing.
+ *
+ * @param threads Working threads.
+ */
+static void cpus_create(array_tt threads)
+{
+	int nthreads; /* Number of threads.           */
+	int *count;   /* Threads per hardware thread. */
+
+	nthreads = array_size(threads);
+
+	cpus.ncpus = timeslice_ncpus;
+	cpus.off = smalloc((cpus.ncpus + 1)*sizeof(int));
+	cpus.tidx = smalloc(nthreads*sizeof(int));
+	cpus.cpu = smalloc(nthreads*sizeof(int));
+	cpus.current = smalloc(cpus.ncpus*sizeof(int));
+	cpus.sliceend = smalloc(cpus.ncpus*sizeof(double));
+	cpus.switchend = smalloc(cpus.ncpus*sizeof(double));
+	cpus.vruntime = smalloc(nthreads*sizeof(double));
+	count = smalloc(cpus.ncpus*sizeof(int));
+
+	for (int c = 0; c <= cpus.ncpus; c++)
+		cpus.off[c] = 0;
+	for (int i = 0; i < nthreads; i++)
 	{
 		thread_tt t = array_get(threads, i);
-		queue_insert(ready, t);
+
+		cpus.vruntime[i] = 0.0;
+
+		assert(thread_cpu(t) < cpus.ncpus);
+		cpus.cpu[thread_gettid(t)%nthreads] = thread_cpu(t);
+		cpus.off[thread_cpu(t) + 1]++;
+	}
+	for (int c = 0; c < cpus.ncpus; c++)
+	{
+		cpus.off[c + 1] += cpus.off[c];
+		cpus.current[c] = -1;
+		cpus.sliceend[c] = 0.0;
+		cpus.switchend[c] = 0.0;
+		count[c] = 0;
+	}
+
+	/* Threads of each hardware thread, in round-robin order. */
+	for (int i = 0; i < nthreads; i++)
+		cpus.tidx[cpus.off[cpus.cpu[i]] + count[cpus.cpu[i]]++] = i;
+	free(count);
+}
+
+/**
+ * @brief Tears down time slicing.
+ */
+static void cpus_destroy(void)
+{
+	free(cpus.vruntime);
+	free(cpus.switchend);
+	free(cpus.sliceend);
+	free(cpus.current);
+	free(cpus.cpu);
+	free(cpus.tidx);
+	free(cpus.off);
+	cpus.current = NULL;
+}
+
+/**
+ * @brief Asserts whether a thread holds its hardware thread.
+ *
+ * @param tidx Thread index.
+ *
+ * @returns True if the thread may run now, and false otherwise.
+ */
+static bool cpus_running(int tidx)
+{
+	int c; /* Hardware thread. */
+
+	/* No time slicing. */
+	if (cpus.current == NULL)
+		return (true);
+
+	c = cpus.cpu[tidx];
+
+	return ((cpus.current[c] == tidx) && (cpus.switchend[c] <= now));
+}
+
+/**
+ * @brief Picks the threads that run on hardware threads.
+ *
+ * @details A thread keeps its hardware thread until its time slice
+ * expires or it has nothing to run. The next thread is then picked
+ * either in round-robin order, and runs for a full time slice, or by
+ * least run time, and runs for an even share of the time slice among
+ * runnable threads, like in CFS. Switching to another thread costs a
+ * context switch, during which no thread runs.
+ *
+ * @param runnable Threads that have work to run, or to take.
+ *
+ * @returns The time of the next context switch.
+ */
+static double cpus_schedule(const bool *runnable)
+{
+	double next = INFINITY; /* Next context switch. */
+
+	for (int c = 0; c < cpus.ncpus; c++)
+	{
+		int n;         /* Number of threads.          */
+		int pos;       /* Position of current thread. */
+		int nrunnable; /* Runnable threads.           */
+		int cur;       /* Current thread.             */
+		int pick;      /* Next thread.                */
+		const int *list = &cpus.tidx[cpus.off[c]];
+
+		n = cpus.off[c + 1] - cpus.off[c];
+		cur = cpus.current[c];
+
+		pos = -1; nrunnable = 0;
+		for (int k = 0; k < n; k++)
+		{
+			if (runnable[list[k]])
+				nrunnable++;
+			if (list[k] == cur)
+				pos = k;
+		}
+
+		/* Time slice expired. */
+		if ((cur < 0) || (!runnable[cur]) || (cpus.sliceend[c] <= now))
+		{
+			pick = -1;
+			if (timeslice_policy == TIMESLICE_RR)
+			{
+				for (int k = 1; k <= n; k++)
+				{
+					if (runnable[list[(pos + k)%n]])
+					{
+						pick = list[(pos + k)%n];
+						break;
+					}
+				}
+			}
+			else
+			{
+				pick = ((cur >= 0) && (runnable[cur])) ? cur : -1;
+				for (int k = 0; k < n; k++)
+				{
+					if ((runnable[list[k]]) &&
+						((pick < 0) || (cpus.vruntime[list[k]] < cpus.vruntime[pick])))
+						pick = list[k];
+				}
+			}
+
+			/* Idle. */
+			if (pick < 0)
+				continue;
+
+			/* Context switch. */
+			if ((cur >= 0) && (pick != cur))
+			{
+				cpus.switchend[c] = now + timeslice_switch;
+				overhead += timeslice_switch;
+				nswitches++;
+			}
+
+			cpus.current[c] = pick;
+			cpus.sliceend[c] = ((cpus.switchend[c] > now) ? cpus.switchend[c] : now) +
+				((timeslice_policy == TIMESLICE_RR) ? timeslice_quantum : timeslice_quantum/nrunnable);
+		}
+
+		if ((cpus.switchend[c] > now) && (next > cpus.switchend[c]))
+			next = cpus.switchend[c];
+		if ((nrunnable > 1) && (next > cpus.sliceend[c]))
+			next = cpus.sliceend[c];
 	}
+
+	return (next);
+}
+
+/**
+ * @brief Computes the cost of the join barrier.
+ *
+ * @param nthreads Number of threads.
+ *
+ * @returns The cost of a tree barrier across all threads.
+ */
+static double simsched_barrier(int nthreads)
+{
+	int nlevels = 0; /* Levels of the tree. */
+
+	while ((1 << nlevels) < nthreads)
+		nlevels++;
+
+	return (forkjoin_barrier*nlevels);
 }
 
 /**
@@ -75,25 +489,33 @@ static void threads_spawn(array_tt threads, bool pinthreads)
  */
 static void threads_join(void)
 {
-	dqueue_destroy(running);
+	heap_destroy(dispatching);
+	dqueue_destroy(dispatched);
+	heap_destroy(running);
 	queue_destroy(ready);
 }
 
 /**
  * @brief Dumps simulation statistics.
  *
- * @param threads Working threads.
+ * @param threads  Working threads.
+ * @param makespan Simulated makespan.
+ *
+ * @returns The simulated makespan.
  */
-static void simsched_dump(array_tt threads)
+static double simsched_dump(array_tt threads, double makespan)
 {
 	double min, max, total;
 	double mean, stddev;
+	double remote;
+	int ntasks, nhits, nreuses;
 	int nthreads;
 
 	nthreads = array_size(threads);
 
 	min = INT_MAX; max = INT_MIN;
-	total = 0; mean = 0.0; stddev = 0.0;
+	total = 0; mean = 0.0; stddev = 0.0; remote = 0.0;
+	ntasks = 0; nhits = 0; nreuses = 0;
 
 	/* Compute min, max, total. */
 	for (int i = 0; i < nthreads; i++)
@@ -110,6 +532,10 @@ static void simsched_dump(array_tt threads)
 			max = wtotal;
 
 		total += wtotal;
+		remote += thread_wremote(t);
+		ntasks += thread_ntasks(t);
+		nhits += thread_nhits(t);
+		nreuses += thread_nreuses(t);
 	}
 
 	/* Compute mean. */
@@ -128,12 +554,29 @@ static void simsched_dump(array_tt threads)
 
 	/* Print statistics. */
 	printf("nchunks: %d\n", nchunks);
-	printf("time: %lf\n", max);
-	printf("cost: %lf\n", max*nthreads);
-	printf("performance: %lf\n", total/max);
+	printf("time: %lf\n", makespan);
+	printf("cost: %lf\n", makespan*nthreads);
+	printf("overhead: %lf\n", overhead);
+	printf("performance: %lf\n", total/makespan);
 	printf("total: %lf\n", total);
 	printf("cov: %lf\n", stddev/mean);
 	printf("slowdown: %lf\n", max/((double) min));
+	if (numa_nnodes > 1)
+		printf("remote: %lf\n", remote/total);
+	if (bandwidth_limit > 0.0)
+		printf("saturated: %lf\n", saturated/makespan);
+	if (smt_corun < 1.0)
+		printf("corun: %lf\n", (busytime > 0.0) ? corun/busytime : 0.0);
+	if (simsched_oversubscribed(nthreads))
+		printf("switches: %d\n", nswitches);
+	if (pool.elastic)
+		printf("redistributed: %lf\n", ((double) pool.nredistributed)/ntasks);
+	if ((locality_footprint > 0) && (locality_cache > 0))
+		printf("hits: %lf\n", ((double) nhits)/ntasks);
+	if ((locality_footprint > 0) && (locality_cache > 0) && (locality_persist))
+		printf("reuse: %lf\n", ((double) nreuses)/ntasks);
+
+	return (makespan);
 }
 
 /**
@@ -165,50 +608,896 @@ static thread_tt choose_thread(queue_tt q)
 }
 
 /**
- * @brief Simulates a parallel loop.
+ * @brief Computes the overhead of a dispatch.
  *
- * @param w         Workload.
- * @param threads   Working threads.
- * @param strategy  Scheduling strategy.
- * @param chunksize Chunksize;
+ * @details A dispatch costs a fixed amount plus a contention term for
+ * each other dispatch that is in progress at the same time.
+ *
+ * @param t Requesting thread.
+ *
+ * @returns The overhead of a dispatch that starts now.
  */
-void simshed(const_workload_tt w, array_tt threads, const struct scheduler *strategy, int chunksize)
+static double simsched_overhead(thread_tt t)
 {
-	/* Sanity check. */
-	assert(w != NULL);
-	assert(threads != NULL);
-	assert(strategy != NULL);
+	double cost; /* Dispatch overhead. */
 
-	threads_spawn(threads, strategy->pinthreads);
+	/* Retire finished dispatches. */
+	while ((!heap_empty(dispatching)) && (heap_min(dispatching) <= now))
+		heap_remove(dispatching);
 
-	strategy->init(w, threads, chunksize);
+	cost = overhead_dispatch + overhead_contention*heap_size(dispatching);
+	heap_insert(dispatching, t, now + cost);
 
-	/* Simulate. */
-	for (int i = 0; i < workload_ntasks(w); /* noop */)
+	overhead += cost;
+
+	return (cost);
+}
+
+/**
+ * @brief Makes a thread leave the loop.
+ *
+ * @details The work of absent threads that the thread had taken over
+ * is released, and the work left in its current chunk is orphaned,
+ * along with its share of the workload charged to the thread.
+ *
+ * @param t         Leaving thread.
+ * @param c         Current chunk (NULL if none).
+ * @param remaining Work left in the current chunk.
+ */
+static void simsched_leave(thread_tt t, const struct chunk *c, double remaining)
+{
+	int nthreads; /* Number of threads. */
+
+	nthreads = array_size(pool.threads);
+
+	for (int i = 0; i < nthreads; i++)
+	{
+		if (pool.adopter[i] == thread_gettid(t)%nthreads)
+			pool.adopter[i] = -1;
+	}
+
+	if ((c != NULL) && (c->work > 0.0) && (remaining > 0.0))
+	{
+		double f = remaining/c->work;
+		struct chunk *o = smalloc(sizeof(struct chunk));
+
+		o->work = remaining;
+		o->ntasks = ceil(c->ntasks*f);
+		if (o->ntasks < 1)
+			o->ntasks = 1;
+		o->capacity = thread_capacity(t);
+		o->wtotal = c->wtotal*f;
+		o->wremote = c->wremote*f;
+		o->bytes = c->bytes*f;
+		thread_charge(t, -o->wtotal, -o->wremote, -o->bytes);
+		queue_insert(pool.orphans, o);
+	}
+}
+
+/**
+ * @brief Hands out work of absent threads to a thread.
+ *
+ * @details Threads that have not arrived yet, or that have left, are
+ * absent. Work left unfinished by threads that left is handed out
+ * first, rescaled to the capacity of the requesting thread, which is
+ * charged with its workload. Then, the
+ * work planned for absent threads is handed out one chunk at a time,
+ * by asking the scheduling strategy for a chunk on their behalf.
+ * Either idle threads split the work of absent threads (steal), or the
+ * first idle thread that takes over work of an absent thread takes
+ * over all of it (adopt).
+ *
+ * @param strategy Scheduling strategy.
+ * @param t        Requesting thread.
+ * @param n        Number of tasks handed out (output).
+ *
+ * @returns The number of tasks newly scheduled.
+ */
+static int simsched_redistribute(const struct scheduler *strategy, thread_tt t, int *n)
+{
+	int tidx;     /* Thread index.      */
+	int nthreads; /* Number of threads. */
+
+	*n = 0;
+	if (!pool.elastic)
+		return (0);
+
+	nthreads = array_size(pool.threads);
+	tidx = thread_gettid(t)%nthreads;
+
+	/* Orphaned work. */
+	if (!queue_empty(pool.orphans))
+	{
+		int k;           /* Tasks handed out.    */
+		double f;        /* Share handed out.    */
+		double work;     /* Work handed out.     */
+		double capacity; /* Capacity of owner.   */
+		struct chunk *o; /* Orphaned work.       */
+
+		o = queue_remove(pool.orphans);
+		capacity = o->capacity;
+
+		k = o->ntasks;
+		if ((elastic_policy == ELASTIC_STEAL) && (k > (o->ntasks + nthreads - 1)/nthreads))
+			k = (o->ntasks + nthreads - 1)/nthreads;
+		f = ((double) k)/o->ntasks;
+		work = o->work*f;
+
+		thread_charge(t, o->wtotal*f, o->wremote*f, o->bytes*f);
+		o->wtotal -= o->wtotal*f;
+		o->wremote -= o->wremote*f;
+		o->bytes -= o->bytes*f;
+		o->work -= work;
+		o->ntasks -= k;
+		if (o->ntasks > 0)
+			queue_insert(pool.orphans, o);
+		else
+			free(o);
+
+		dqueue_insert(dispatched, t, floor(work*thread_capacity(t)/capacity + 0.5));
+		pool.nredistributed += k;
+		*n = k;
+
+		return (0);
+	}
+
+	for (int i = 0; i < nthreads; i++)
+	{
+		int aidx;    /* Absent thread index. */
+		thread_tt a; /* Absent thread.       */
+
+		a = array_get(pool.threads, i);
+		aidx = thread_gettid(a)%nthreads;
+
+		/* Present. */
+		if ((now >= pool.origin + thread_arrival(a)) && (now < pool.origin + thread_departure(a)))
+			continue;
+
+		/* Taken over by another thread. */
+		if ((elastic_policy == ELASTIC_ADOPT) && (pool.adopter[aidx] >= 0) && (pool.adopter[aidx] != tidx))
+			continue;
+
+		thread_set_proxy(a, t);
+		*n = strategy->sched(dispatched, a);
+		thread_set_proxy(a, NULL);
+
+		if (dqueue_empty(dispatched))
+			continue;
+
+		/* Nothing planned. */
+		if (*n == 0)
+		{
+			dqueue_remove(dispatched);
+			continue;
+		}
+
+		pool.adopter[aidx] = tidx;
+		pool.nredistributed += *n;
+
+		return (*n);
+	}
+
+	return (0);
+}
+
+/**
+ * @brief Hands out a chunk to a thread.
+ *
+ * @details Threads that have no work of their own left take over work
+ * of absent threads, at a cost.
+ *
+ * @param w        Workload.
+ * @param strategy Scheduling strategy.
+ * @param t        Requesting thread.
+ * @param busy     Processing time of the chunk (output).
+ *
+ * @returns The number of tasks in the chunk. Zero means that the
+ * thread has no more work.
+ */
+static int simsched_dispatch(const_workload_tt w, const struct scheduler *strategy, thread_tt t, int *busy)
+{
+	int n = 0;          /* Number of tasks in the chunk. */
+	bool redistributed; /* Work of an absent thread?     */
+
+	/* Leave. */
+	if (now >= pool.origin + thread_departure(t))
+	{
+		simsched_leave(t, NULL, 0.0);
+		return (0);
+	}
+
+	/* Own work. */
+	if (nscheduled < workload_ntasks(w))
+	{
+		n = strategy->sched(dispatched, t);
+		if (!dqueue_empty(dispatched))
+			nscheduled += n;
+	}
+
+	/* Work of absent threads. */
+	redistributed = false;
+	if (dqueue_empty(dispatched))
+	{
+		nscheduled += simsched_redistribute(strategy, t, &n);
+		if (dqueue_empty(dispatched))
+			return (0);
+		redistributed = true;
+	}
+
+	*busy = dqueue_next_counter(dispatched);
+	dqueue_remove(dispatched);
+
+	/* Redistribution cost. */
+	if (redistributed)
+	{
+		*busy += floor(elastic_cost*n + 0.5);
+		overhead += floor(elastic_cost*n + 0.5);
+	}
+
+	return (n);
+}
+
+/**
+ * @brief Simulates a parallel loop in which threads run independently.
+ *
+ * @param w        Workload.
+ * @param strategy Scheduling strategy.
+ */
+static void simsched_run(const_workload_tt w, const struct scheduler *strategy)
+{
+	while (true)
 	{
 		/* Schedule ready threads. */
 		while (!queue_empty(ready))
 		{
-			thread_tt t;
+			int busy;    /* Processing time. */
+			thread_tt t; /* Target thread.   */
 
 			t = choose_thread(ready);
-			i += strategy->sched(running, t);
+
+			if (simsched_dispatch(w, strategy, t, &busy) == 0)
+				continue;
+
+			heap_insert(running, t, thread_finish(t, now + simsched_overhead(t), busy));
 		}
 
+		/* Done. */
+		if (heap_empty(running))
+			break;
+
 		/* Reschedule running threads. */
-		while (!dqueue_empty(running))
+		now = heap_min(running);
+		while ((!heap_empty(running)) && (heap_min(running) == now))
+			queue_insert(ready, heap_remove(running));
+	}
+}
+
+/**
+ * @brief Simulates a parallel loop in which threads share resources.
+ *
+ * @details The rate at which a thread progresses depends on what the
+ * other threads do, so rates are recomputed at every event: the start
+ * or the end of a chunk, or a speed change. Threads whose SMT sibling
+ * is busy run at a fraction of their speed. When the memory traffic
+ * of running threads exceeds the memory bandwidth, threads that access
+ * memory are slowed down evenly, so that their traffic matches the
+ * memory bandwidth. Threads that outnumber hardware threads take
+ * turns to run on them, and take chunks only on their turn. Threads
+ * that leave stop at once, and idle threads wait for the work that
+ * they leave unfinished.
+ *
+ * @param w        Workload.
+ * @param threads  Working threads.
+ * @param strategy Scheduling strategy.
+ */
+static void simsched_run_shared(const_workload_tt w, array_tt threads, const struct scheduler *strategy)
+{
+	int nthreads;        /* Number of threads.        */
+	int nrunning;        /* Number of running chunks. */
+	thread_tt *slot;     /* Running threads.          */
+	double *start;       /* Start of chunks.          */
+	double *remaining;   /* Remaining work.           */
+	double *intensity;   /* Memory intensity.         */
+	double *rate;        /* Progress rates.           */
+	int *corebusy;       /* Busy threads per core.    */
+	bool *runnable;      /* Threads wanting to run.   */
+	bool timesliced;     /* Time slicing?             */
+	struct chunk *chunk; /* Current chunks.           */
+	thread_tt *parked;   /* Waiting for hardware.     */
+	int nparked;         /* Number of waiting ones.   */
+	queue_tt idle;       /* Idle threads.             */
+
+	nthreads = array_size(threads);
+	timesliced = simsched_oversubscribed(nthreads);
+
+	slot = smalloc(nthreads*sizeof(thread_tt));
+	for (int i = 0; i < nthreads; i++)
+		slot[i] = NULL;
+	start = smalloc(nthreads*sizeof(double));
+	remaining = smalloc(nthreads*sizeof(double));
+	intensity = smalloc(nthreads*sizeof(double));
+	rate = smalloc(nthreads*sizeof(double));
+	corebusy = smalloc(((smt_ncores > 0) ? smt_ncores : 1)*sizeof(int));
+	runnable = smalloc(nthreads*sizeof(bool));
+	chunk = smalloc(nthreads*sizeof(struct chunk));
+	for (int i = 0; i < nthreads; i++)
+		chunk[i].work = 0.0;
+	parked = smalloc(nthreads*sizeof(thread_tt));
+	for (int i = 0; i < nthreads; i++)
+		parked[i] = NULL;
+	nparked = 0;
+	idle = queue_create();
+	if (timesliced)
+		cpus_create(threads);
+
+	/* Threads that are not yet awake. */
+	nrunning = 0;
+	while (!heap_empty(running))
+	{
+		int tidx;      /* Thread index. */
+		double wakeup; /* Wake-up time. */
+		thread_tt t;   /* Thread.       */
+
+		wakeup = heap_min(running);
+		t = heap_remove(running);
+		tidx = thread_gettid(t)%nthreads;
+
+		slot[tidx] = t;
+		start[tidx] = wakeup;
+		remaining[tidx] = 0.0;
+		intensity[tidx] = 0.0;
+		nrunning++;
+	}
+
+	while (true)
+	{
+		double next;   /* Next event.                */
+		double demand; /* Memory traffic.            */
+		double factor; /* Memory bandwidth slowdown. */
+
+		/* Threads that leave. */
+		for (int i = 0; (pool.elastic) && (i < nthreads); i++)
 		{
-			queue_insert(ready, dqueue_remove(running));
+			if ((slot[i] == NULL) || (now < pool.origin + thread_departure(slot[i])))
+				continue;
+
+			simsched_leave(slot[i], &chunk[i], remaining[i]);
+			slot[i] = NULL;
+			nrunning--;
+
+			/* Wake up idle threads. */
+			while (!queue_empty(idle))
+				queue_insert(ready, queue_remove(idle));
+		}
+
+		/*
+		 * Schedule ready threads. Threads that outnumber hardware
+		 * threads only take chunks when they hold their hardware
+		 * thread.
+		 */
+		while (true)
+		{
+			while (!queue_empty(ready))
+			{
+				int n;          /* Number of tasks.  */
+				int busy;       /* Processing time.  */
+				int tidx;       /* Thread index.     */
+				double bytes;   /* Memory traffic.   */
+				double wtotal;  /* Workload.         */
+				double wremote; /* Remote workload.  */
+				thread_tt t;    /* Target thread.    */
+
+				t = choose_thread(ready);
+				tidx = thread_gettid(t)%nthreads;
+
+				/* Wait for a hardware thread. */
+				if (!cpus_running(tidx))
+				{
+					parked[tidx] = t;
+					nparked++;
+					continue;
+				}
+
+				bytes = thread_bytes(t);
+				wtotal = thread_wtotal(t);
+				wremote = thread_wremote(t);
 
-			if (dqueue_next_counter(running) != 0)
+				if ((n = simsched_dispatch(w, strategy, t, &busy)) == 0)
+				{
+					/* Others may leave work unfinished. */
+					if ((pool.elastic) && (now < pool.origin + thread_departure(t)))
+						queue_insert(idle, t);
+					continue;
+				}
+
+				slot[tidx] = t;
+				start[tidx] = now + simsched_overhead(t);
+				remaining[tidx] = busy;
+				intensity[tidx] = (busy > 0) ? (thread_bytes(t) - bytes)/busy : 0.0;
+				chunk[tidx].work = busy;
+				chunk[tidx].ntasks = n;
+				chunk[tidx].capacity = thread_capacity(t);
+				chunk[tidx].wtotal = (thread_wtotal(t) - wtotal)*thread_rate(t);
+				chunk[tidx].wremote = (thread_wremote(t) - wremote)*thread_rate(t);
+				chunk[tidx].bytes = (thread_bytes(t) - bytes)*thread_rate(t);
+				nrunning++;
+			}
+
+			next = INFINITY;
+			if (!timesliced)
+				break;
+
+			/* Time slicing. */
+			for (int i = 0; i < nthreads; i++)
+			{
+				runnable[i] = (parked[i] != NULL) ||
+					((slot[i] != NULL) && (start[i] <= now) && (remaining[i] > 0.0));
+			}
+			next = cpus_schedule(runnable);
+
+			/* Threads that got their hardware thread. */
+			for (int i = 0; i < nthreads; i++)
+			{
+				if ((parked[i] == NULL) || (!cpus_running(i)))
+					continue;
+
+				queue_insert(ready, parked[i]);
+				parked[i] = NULL;
+				nparked--;
+			}
+
+			if (queue_empty(ready))
 				break;
 		}
+
+		/* Done. */
+		if ((nrunning == 0) && (nparked == 0))
+			break;
+
+		/* Busy SMT siblings. */
+		for (int i = 0; i < smt_ncores; i++)
+			corebusy[i] = 0;
+		for (int i = 0; (smt_ncores > 0) && (i < nthreads); i++)
+		{
+			if ((slot[i] != NULL) && (remaining[i] > 0.0) && (cpus_running(i)))
+				corebusy[thread_core(slot[i])]++;
+		}
+
+		/* Compute progress rates. */
+		demand = 0.0;
+		for (int i = 0; i < nthreads; i++)
+		{
+			double change; /* Next speed change. */
+
+			if (slot[i] == NULL)
+				continue;
+
+			/* Departure. */
+			if (next > pool.origin + thread_departure(slot[i]))
+				next = pool.origin + thread_departure(slot[i]);
+
+			/* Dispatching. */
+			if (start[i] > now)
+			{
+				rate[i] = 0.0;
+				if (next > start[i])
+					next = start[i];
+				continue;
+			}
+
+			/* Waiting for its turn. */
+			if (!cpus_running(i))
+			{
+				rate[i] = 0.0;
+				continue;
+			}
+
+			rate[i] = thread_speed(slot[i], now, &change);
+			if (next > change)
+				next = change;
+
+			/* SMT sibling. */
+			if ((smt_ncores > 0) && (corebusy[thread_core(slot[i])] > 1))
+				rate[i] *= smt_corun;
+
+			demand += intensity[i]*rate[i];
+		}
+
+		/* Memory bandwidth. */
+		factor = 1.0;
+		if ((bandwidth_limit > 0.0) && (demand > bandwidth_limit))
+			factor = bandwidth_limit/demand;
+
+		for (int i = 0; i < nthreads; i++)
+		{
+			if ((slot[i] == NULL) || (rate[i] == 0.0))
+				continue;
+
+			if (intensity[i] > 0.0)
+				rate[i] *= factor;
+
+			if (next > now + remaining[i]/rate[i])
+				next = now + remaining[i]/rate[i];
+		}
+
+		/* Advance time. */
+		if (factor < 1.0)
+			saturated += next - now;
+		for (int i = 0; i < nthreads; i++)
+		{
+			if ((slot[i] == NULL) || (start[i] > now) || (remaining[i] <= 0.0) || (!cpus_running(i)))
+				continue;
+
+			if (timesliced)
+				cpus.vruntime[i] += next - now;
+			busytime += next - now;
+			if ((smt_ncores > 0) && (corebusy[thread_core(slot[i])] > 1))
+				corun += next - now;
+
+			remaining[i] -= rate[i]*(next - now);
+		}
+		now = next;
+
+		/* Reschedule threads that are done. */
+		for (int i = 0; i < nthreads; i++)
+		{
+			if ((slot[i] == NULL) || (start[i] > now) || (remaining[i] > 1e-6))
+				continue;
+
+			queue_insert(ready, slot[i]);
+			slot[i] = NULL;
+			nrunning--;
+		}
 	}
 
-	strategy->end();
+	/* House keeping. */
+	if (timesliced)
+		cpus_destroy();
+	queue_destroy(idle);
+	free(parked);
+	free(chunk);
+	free(runnable);
+	free(corebusy);
+	free(rate);
+	free(intensity);
+	free(remaining);
+	free(start);
+	free(slot);
+}
 
-	simsched_dump(threads);
+/**
+ * @brief Is the current strategy holding a plan?
+ */
+static bool planned = false;
+
+/**
+ * @brief Simulates one instance of a parallel loop.
+ *
+ * @details The plan of the strategy is kept across instances, unless
+ * @p replan is set. Call simshed_end() after the last instance.
+ *
+ * @param w         Workload.
+ * @param threads   Working threads.
+ * @param strategy  Scheduling strategy.
+ * @param chunksize Chunksize;
+ * @param replan    Discard current plan?
+ *
+ * @returns The simulated makespan.
+ */
+double simshed_step(const_workload_tt w, array_tt threads, const struct scheduler *strategy, int chunksize, bool replan)
+{
+	double makespan; /* Simulated makespan. */
+
+	/* Sanity check. */
+	assert(w != NULL);
+	assert(threads != NULL);
+	assert(strategy != NULL);
+
+	for (int i = 0; i < array_size(threads); i++)
+		thread_reset(array_get(threads, i));
+	background_reset();
+
+	threads_spawn(threads, (strategy->pinthreads) || (locality_pin));
+
+	if ((replan) && (planned))
+		strategy->end();
+
+	/* Planning happens before threads start. */
+	now = overhead_plan*strategy->init(w, threads, chunksize);
+	overhead += now;
+	planned = true;
+
+	/* Elastic thread pool. */
+	pool.threads = threads;
+	pool.origin = now;
+	pool.nredistributed = 0;
+	pool.elastic = false;
+	for (int i = 0; i < array_size(threads); i++)
+	{
+		thread_tt t = array_get(threads, i);
+
+		if ((thread_arrival(t) > 0.0) || (thread_departure(t) < INFINITY))
+			pool.elastic = true;
+	}
+	if (pool.elastic)
+	{
+		pool.adopter = smalloc(array_size(threads)*sizeof(int));
+		for (int i = 0; i < array_size(threads); i++)
+			pool.adopter[i] = -1;
+		pool.orphans = queue_create();
+	}
+
+	threads_wakeup(threads);
+
+	/* Simulate. */
+	nscheduled = 0;
+	saturated = 0.0;
+	corun = 0.0;
+	busytime = 0.0;
+	nswitches = 0;
+	if ((bandwidth_limit > 0.0) || (smt_corun < 1.0) || (simsched_oversubscribed(array_size(threads))) || (pool.elastic))
+		simsched_run_shared(w, threads, strategy);
+	else
+		simsched_run(w, strategy);
+
+	if (pool.elastic)
+	{
+		if ((nscheduled < workload_ntasks(w)) || (!queue_empty(pool.orphans)))
+			error("threads left before the end of the loop");
+		queue_destroy(pool.orphans);
+		free(pool.adopter);
+	}
+
+	/* Join. */
+	overhead += simsched_barrier(array_size(threads));
+	makespan = now + simsched_barrier(array_size(threads));
 
 	threads_join();
+
+	return (makespan);
+}
+
+/**
+ * @brief Discards the plan of a scheduling strategy.
+ *
+ * @param strategy Scheduling strategy.
+ */
+void simshed_end(const struct scheduler *strategy)
+{
+	/* Sanity check. */
+	assert(strategy != NULL);
+
+	if (planned)
+		strategy->end();
+	planned = false;
+}
+
+/**
+ * @brief Simulates a parallel loop.
+ *
+ * @param w         Workload.
+ * @param threads   Working threads.
+ * @param strategy  Scheduling strategy.
+ * @param chunksize Chunksize;
+ *
+ * @returns The simulated makespan.
+ */
+double simshed(const_workload_tt w, array_tt threads, const struct scheduler *strategy, int chunksize)
+{
+	double makespan; /* Simulated makespan. */
+
+	makespan = simshed_step(w, threads, strategy, chunksize, true);
+	simshed_end(strategy);
+
+	return (simsched_dump(threads, makespan));
 }
 
+/**
+ * @brief Simulates a parallel loop split across nodes.
+ *
+ * @details Threads are split into nodes, in contiguous blocks. The
+ * outer strategy hands out chunks to nodes, as if each node was a
+ * thread as fast as all of its threads together. A chunk reaches its
+ * node after the inter-node latency, and then the node runs it as a
+ * loop of its own, scheduled among its threads by the inner strategy.
+ * A node asks for its next chunk once it is done with the current
+ * one. Nodes join in a tree, at the inter-node latency per level.
+ *
+ * @param w          Workload.
+ * @param threads    Working threads.
+ * @param outer      Scheduling strategy across nodes.
+ * @param inner      Scheduling strategy within nodes.
+ * @param outerchunk Chunksize across nodes.
+ * @param innerchunk Chunksize within nodes.
+ *
+ * @returns The simulated makespan.
+ */
+double simshed_hierarchical(const_workload_tt w, array_tt threads, const struct scheduler *outer, const struct scheduler *inner, int outerchunk, int innerchunk)
+{
+	int nnodes;         /* Number of nodes.             */
+	int nthreads;       /* Number of threads.           */
+	int ntasks;         /* Number of tasks.             */
+	int nscheduled;     /* Tasks handed out to nodes.   */
+	int nodechunks;     /* Chunks handed out to nodes.  */
+	int *tasks;         /* Tasks of a chunk.            */
+	double *nodebusy;   /* Time spent by nodes running. */
+	double clock;       /* Current time.                */
+	double makespan;    /* Simulated makespan.          */
+	double min, max;    /* Least and most busy nodes.   */
+	array_tt nodes;     /* Nodes, seen as threads.      */
+	array_tt *members;  /* Threads of each node.        */
+	queue_tt idle;      /* Nodes waiting for work.      */
+	heap_tt busy;       /* Nodes running, by end time.  */
+	dqueue_tt chunks;   /* Chunks handed out to nodes.  */
+
+	/* Sanity check. */
+	assert(w != NULL);
+	assert(threads != NULL);
+	assert(outer != NULL);
+	assert(inner != NULL);
+
+	nnodes = hierarchy_nnodes;
+	nthreads = array_size(threads);
+	ntasks = workload_ntasks(w);
+
+	if ((nnodes < 1) || (nnodes > nthreads))
+		error("bad number of nodes");
+
+	/* Strategies keep a single plan, so levels cannot share one. */
+	if ((outer->sched == inner->sched) || (outer == sched_auto) || (inner == sched_auto))
+		error("outer and inner strategies must differ");
+
+	/*
+	 * Split threads into nodes. Strategies find the work of a thread
+	 * by its ID, so each node is placed where its ID points to, along
+	 * with its threads.
+	 */
+	nodes = array_create(nnodes);
+	members = smalloc(nnodes*sizeof(array_tt));
+	for (int k = 0; k < nnodes; k++)
+	{
+		int j;       /* Position of the node. */
+		double rate; /* Speed of the node.    */
+		thread_tt node;
+		int first = ((long) k)*nthreads/nnodes;
+		int last = ((long) (k + 1))*nthreads/nnodes;
+
+		rate = 0.0;
+		for (int i = first; i < last; i++)
+			rate += thread_rate(array_get(threads, i));
+
+		node = thread_create(1.0/rate);
+		j = thread_gettid(node)%nnodes;
+
+		members[j] = array_create(last - first);
+		for (int i = first; i < last; i++)
+			array_set(members[j], i - first, array_get(threads, i));
+
+		array_set(nodes, j, node);
+	}
+
+	tasks = smalloc(ntasks*sizeof(int));
+	nodebusy = smalloc(nnodes*sizeof(double));
+	for (int j = 0; j < nnodes; j++)
+		nodebusy[j] = 0.0;
+	idle = queue_create();
+	busy = heap_create(nnodes);
+	chunks = dqueue_create();
+
+	/* Planning happens before nodes start. */
+	nodechunks = nchunks;
+	clock = overhead_plan*outer->init(w, nodes, outerchunk);
+	overhead += clock;
+	nchunks = nodechunks;
+
+	for (int j = 0; j < nnodes; j++)
+		queue_insert(idle, array_get(nodes, j));
+
+	/* Simulate. */
+	nscheduled = 0;
+	nodechunks = 0;
+	while (true)
+	{
+		/* Hand out chunks to idle nodes. */
+		while (!queue_empty(idle))
+		{
+			int j;          /* Node index.        */
+			int n;          /* Number of tasks.   */
+			int k;          /* Number of chunks.  */
+			double span;    /* Makespan of chunk. */
+			thread_tt node; /* Target node.       */
+			workload_tt s;  /* Chunk.             */
+
+			node = choose_thread(idle);
+			j = thread_gettid(node)%nnodes;
+
+			if (nscheduled == ntasks)
+				continue;
+
+			/* Only chunks within nodes are counted. */
+			k = nchunks;
+			thread_set_record(node, tasks);
+			outer->sched(chunks, node);
+			n = thread_nrecorded(node);
+			thread_set_record(node, NULL);
+			nchunks = k;
+
+			if (dqueue_empty(chunks))
+				continue;
+			dqueue_remove(chunks);
+
+			/* Nothing planned. */
+			if (n == 0)
+				continue;
+
+			nscheduled += n;
+			nodechunks++;
+
+			/* Run chunk within the node. */
+			k = nchunks;
+			nchunks = 0;
+			s = workload_subset(w, tasks, n, numa_nnodes);
+			span = simshed_step(s, members[j], inner, innerchunk, true);
+			simshed_end(inner);
+			workload_destroy(s);
+			nchunks += k;
+
+			nodebusy[j] += span;
+			overhead += hierarchy_latency;
+			heap_insert(busy, node, clock + hierarchy_latency + span);
+		}
+
+		/* Done. */
+		if (heap_empty(busy))
+			break;
+
+		clock = heap_min(busy);
+		while ((!heap_empty(busy)) && (heap_min(busy) == clock))
+			queue_insert(idle, heap_remove(busy));
+	}
+
+	outer->end();
+
+	if (nscheduled < ntasks)
+		error("tasks left unscheduled");
+
+	/* Join. */
+	makespan = clock;
+	for (int k = 1; k < nnodes; k *= 2)
+	{
+		makespan += hierarchy_latency;
+		overhead += hierarchy_latency;
+	}
+
+	/* Print statistics. */
+	min = INFINITY; max = 0.0;
+	for (int j = 0; j < nnodes; j++)
+	{
+		if (min > nodebusy[j])
+			min = nodebusy[j];
+		if (max < nodebusy[j])
+			max = nodebusy[j];
+	}
+	printf("nchunks: %d\n", nchunks);
+	printf("nodechunks: %d\n", nodechunks);
+	printf("time: %lf\n", makespan);
+	printf("cost: %lf\n", makespan*nthreads);
+	printf("overhead: %lf\n", overhead);
+	printf("slowdown: %lf\n", (min > 0.0) ? max/min : INFINITY);
+
+	/* House keeping. */
+	dqueue_destroy(chunks);
+	heap_destroy(busy);
+	queue_destroy(idle);
+	free(nodebusy);
+	free(tasks);
+	for (int j = 0; j < nnodes; j++)
+	{
+		thread_destroy(array_get(nodes, j));
+		array_destroy(members[j]);
+	}
+	free(members);
+	array_destroy(nodes);
+
+	return (makespan);
+}
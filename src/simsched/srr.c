@@ -35,10 +35,11 @@
  */
 static struct
 {
-	const_workload_tt workload; /**< Workload.   */
-	array_tt threads;           /**< Threads.    */
-	thread_tt *taskmap;         /**< Scheduling. */
-} scheddata = { NULL, NULL, NULL };
+	const_workload_tt workload; /**< Workload.          */
+	array_tt threads;           /**< Threads.           */
+	thread_tt *taskmap;         /**< Scheduling.        */
+	bool *served;               /**< Shares handed out. */
+} scheddata = { NULL, NULL, NULL, NULL };
 
 /**
  * @brief Initializes the srr scheduler.
@@ -46,8 +47,10 @@ static struct
  * @param workload  Target workload.
  * @param threads   Target threads.
  * @param chunksize Chunk size.
+ *
+ * @returns The number of tasks planned.
  */
-void scheduler_srr_init(const_workload_tt workload, array_tt threads, int chunksize)
+int scheduler_srr_init(const_workload_tt workload, array_tt threads, int chunksize)
 {
 	int ntasks;   /* Number of tasks.      */
 	int nthreads; /* Number of threads.    */
@@ -60,9 +63,13 @@ void scheduler_srr_init(const_workload_tt workload, array_tt threads, int chunks
 	assert(workload != NULL);
 	assert(threads != NULL);
 
-	/* Already initialized. */
+	/* Already initialized, so hand out shares again. */
 	if (scheddata.taskmap != NULL)
-		return;
+	{
+		for (int j = 0; j < array_size(threads); j++)
+			scheddata.served[j] = false;
+		return (0);
+	}
 	
 	ntasks = workload_ntasks(workload);
 	nthreads = array_size(threads);
@@ -73,6 +80,9 @@ void scheduler_srr_init(const_workload_tt workload, array_tt threads, int chunks
 	scheddata.workload = workload;
 	scheddata.threads = threads;
 	scheddata.taskmap = smalloc(ntasks*sizeof(thread_tt));
+	scheddata.served = smalloc(array_size(threads)*sizeof(bool));
+	for (int j = 0; j < array_size(threads); j++)
+		scheddata.served[j] = false;
 
 	map = workload_sortmap(workload);
 
@@ -92,7 +102,7 @@ void scheduler_srr_init(const_workload_tt workload, array_tt threads, int chunks
 			tidx = (tidx + 1)%nthreads;
 		}
 		
-		return;
+		return (ntasks);
 	}
 	else
 	{
@@ -108,6 +118,8 @@ void scheduler_srr_init(const_workload_tt workload, array_tt threads, int chunks
 	
 	/* House keeping. */
 	free(map);
+
+	return (ntasks);
 }
 
 /**
@@ -115,6 +127,7 @@ void scheduler_srr_init(const_workload_tt workload, array_tt threads, int chunks
  */
 void scheduler_srr_end(void)
 {
+	free(scheddata.served);
 	free(scheddata.taskmap);
 	scheddata.taskmap = NULL;
 }
@@ -131,6 +144,13 @@ int scheduler_srr_sched(dqueue_tt running, thread_tt t)
 {
 	int n = 0;     /* Number of tasks scheduled. */
 	int wsize = 0; /* Size of assigned work.     */
+	int tidx;      /* Thread index.              */
+
+	/* Share already handed out. */
+	tidx = thread_gettid(t)%array_size(scheddata.threads);
+	if (scheddata.served[tidx])
+		return (0);
+	scheddata.served[tidx] = true;
 
 	/* Get next tasks. */
 	for (int i = 0; i < workload_ntasks(scheddata.workload); i++)
@@ -140,8 +160,7 @@ int scheduler_srr_sched(dqueue_tt running, thread_tt t)
 			continue;
 
 		n++;
-		wsize += workload_task(scheddata.workload, i);
-		thread_assign(t, workload_task(scheddata.workload, i));
+		wsize += thread_assign(t, scheddata.workload, i);
 	}
 	
 	dqueue_insert(running, t, wsize);
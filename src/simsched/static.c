@@ -34,11 +34,12 @@
  */
 static struct
 {
-	const_workload_tt workload; /**< Workload.   */
-	array_tt threads;           /**< Threads.    */
-	thread_tt *taskmap;         /**< Scheduling. */
-	int chunksize;              /**< Chunksize.  */
-} scheddata = { NULL, NULL, NULL, 1 };
+	const_workload_tt workload; /**< Workload.          */
+	array_tt threads;           /**< Threads.           */
+	thread_tt *taskmap;         /**< Scheduling.        */
+	bool *served;               /**< Shares handed out. */
+	int chunksize;              /**< Chunksize.         */
+} scheddata = { NULL, NULL, NULL, NULL, 1 };
 
 /**
  * @brief Initializes the static scheduler.
@@ -46,8 +47,10 @@ static struct
  * @param workload  Target workload.
  * @param threads   Target threads.
  * @param chunksize Chunk size.
+ *
+ * @returns The number of tasks planned.
  */
-void scheduler_static_init(const_workload_tt workload, array_tt threads, int chunksize)
+int scheduler_static_init(const_workload_tt workload, array_tt threads, int chunksize)
 {
 	int tidx;      /* Index of working thread. */
 	int ntasks;    /* Workload size.           */
@@ -57,9 +60,13 @@ void scheduler_static_init(const_workload_tt workload, array_tt threads, int chu
 	assert(threads != NULL);
 	assert(chunksize > 0);
 
-	/* Already initialized. */
+	/* Already initialized, so hand out shares again. */
 	if (scheddata.taskmap != NULL)
-		return;
+	{
+		for (int j = 0; j < array_size(threads); j++)
+			scheddata.served[j] = false;
+		return (0);
+	}
 	
 	ntasks = workload_ntasks(workload);
 
@@ -67,6 +74,9 @@ void scheduler_static_init(const_workload_tt workload, array_tt threads, int chu
 	scheddata.workload = workload;
 	scheddata.threads = threads;
 	scheddata.taskmap = smalloc(ntasks*sizeof(thread_tt));
+	scheddata.served = smalloc(array_size(threads)*sizeof(bool));
+	for (int j = 0; j < array_size(threads); j++)
+		scheddata.served[j] = false;
 		
 	/* Assign tasks to threads. */
 	tidx = 0;
@@ -83,6 +93,8 @@ void scheduler_static_init(const_workload_tt workload, array_tt threads, int chu
 		nchunks++;
 		tidx = (tidx + 1)%array_size(threads);
 	}
+
+	return (0);
 }
 
 /**
@@ -90,6 +102,7 @@ void scheduler_static_init(const_workload_tt workload, array_tt threads, int chu
  */
 void scheduler_static_end(void)
 {
+	free(scheddata.served);
 	free(scheddata.taskmap);
 	scheddata.taskmap = NULL;
 }
@@ -106,6 +119,13 @@ int scheduler_static_sched(dqueue_tt running, thread_tt t)
 {
 	int n = 0;     /* Number of tasks scheduled. */
 	int wsize = 0; /* Size of assigned work.     */
+	int tidx;      /* Thread index.              */
+
+	/* Share already handed out. */
+	tidx = thread_gettid(t)%array_size(scheddata.threads);
+	if (scheddata.served[tidx])
+		return (0);
+	scheddata.served[tidx] = true;
 
 	/* Get next tasks. */
 	for (int i = 0; i < workload_ntasks(scheddata.workload); i++)
@@ -115,8 +135,7 @@ int scheduler_static_sched(dqueue_tt running, thread_tt t)
 			continue;
 
 		n++;
-		wsize += workload_task(scheddata.workload, i);
-		thread_assign(t, workload_task(scheddata.workload, i));
+		wsize += thread_assign(t, scheddata.workload, i);
 	}
 	
 	dqueue_insert(running, t, wsize);
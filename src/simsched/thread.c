@@ -20,22 +20,370 @@
  */
 
 #include <assert.h>
+#include <math.h>
+#include <stdbool.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <mylib/util.h>
 
 #include <thread.h>
+#include <workload.h>
+
+/**
+ * @brief Number of task ranges tracked in a cache.
+ */
+#define LOCALITY_NRANGES 16
+
+/**
+ * @brief Range of tasks.
+ */
+struct range
+{
+	int lo; /**< First task. */
+	int hi; /**< Last task.  */
+};
 
 /**
  * @brief Thread.
  */
 struct thread
 {
-	int tid;      /**< Identification number,   */
-	int wtotal;   /**< Total assigned workload. */
-	int capacity; /**< Processing capacity.     */
+	int tid;              /**< Identification number,    */
+	double wtotal;        /**< Total assigned workload.  */
+	double wremote;       /**< Remote workload.          */
+	double bytes;         /**< Memory traffic.           */
+	double time;          /**< Processing time assigned. */
+	double offset;        /**< Start offset.             */
+	double capacity;      /**< Processing capacity.      */
+	double rate;          /**< Reciprocal of capacity.   */
+	int socket;           /**< Socket.                   */
+	int node;             /**< NUMA node.                */
+	int cache;            /**< Shared cache.             */
+	int type;             /**< Core type.                */
+	int core;             /**< Physical core.            */
+	int cpu;              /**< Hardware thread.          */
+	double arrival;       /**< Time of arrival.          */
+	double departure;     /**< Time of departure.        */
+	struct thread *proxy; /**< Runs tasks on its behalf. */
+	int *record;          /**< Tasks assigned, if kept.  */
+	int nrecorded;        /**< Number of tasks kept.     */
+
+	/**
+	 * @name Speed Profile
+	 */
+	/**@{*/
+	double *segtime; /**< Start of trace segments. */
+	double *segrate; /**< Speed in trace segments. */
+	int nsegments;   /**< Number of segments.      */
+	int seg;         /**< Next segment.            */
+	double stall;    /**< Start of next stall.     */
+	int bgseg;       /**< Next background segment. */
+	/**@}*/
+
+	/**
+	 * @name Cache
+	 */
+	/**@{*/
+	struct range lru[LOCALITY_NRANGES]; /**< Cached tasks, most recent first. */
+	int nranges;                        /**< Number of cached ranges.         */
+	int ntasks;                         /**< Number of tasks run.             */
+	int nhits;                          /**< Tasks run from cache.            */
+	int nreuses;                        /**< Tasks run again from cache.      */
+	/**@}*/
+};
+
+/**
+ * @brief Number of NUMA nodes.
+ */
+int numa_nnodes = 1;
+
+/**
+ * @brief Cost multiplier for remote memory accesses.
+ */
+double numa_remote = 1.0;
+
+/**
+ * @brief Number of task classes.
+ */
+int speed_nclasses = 1;
+
+/**
+ * @brief Number of core types.
+ */
+int speed_ntypes = 1;
+
+/**
+ * @brief Relative cost of each task class on each core type.
+ */
+double *speed_matrix = NULL;
+
+/**
+ * @brief Returns the relative cost of a task class on a core type.
+ *
+ * @param tclass Task class.
+ * @param type   Core type.
+ *
+ * @returns The relative cost of the task class on the core type.
+ */
+double speed_factor(int tclass, int type)
+{
+	/* Sanity check. */
+	assert((tclass >= 0) && (type >= 0) && (type < speed_ntypes));
+
+	if (speed_matrix == NULL)
+		return (1.0);
+
+	assert(tclass < speed_nclasses);
+
+	return (speed_matrix[tclass*speed_ntypes + type]);
+}
+
+/**
+ * @brief Memory bandwidth of the machine (0 for unlimited).
+ */
+double bandwidth_limit = 0.0;
+
+/**
+ * @brief Default memory intensity of a task (bytes per unit of work).
+ */
+double bandwidth_intensity = 0.0;
+
+/**
+ * @brief Number of physical cores.
+ */
+int smt_ncores = 0;
+
+/**
+ * @brief Relative speed of a thread whose sibling is busy.
+ */
+double smt_corun = 1.0;
+
+/**
+ * @brief Memory footprint of a task (in bytes).
+ */
+int locality_footprint = 0;
+
+/**
+ * @brief Size of the cache of a core (in bytes).
+ */
+int locality_cache = 0;
+
+/**
+ * @brief Relative cost of a task whose data is cached.
+ */
+double locality_warm = 0.5;
+
+/**
+ * @brief Relative cost of a task that is run again from the cache.
+ */
+double locality_reuse = 0.25;
+
+/**
+ * @brief Keep caches across loop instances?
+ */
+bool locality_persist = false;
+
+/**
+ * @brief Pin threads to cores?
+ */
+bool locality_pin = false;
+
+/**
+ * @brief Jitter model.
+ */
+enum jitter_model jitter_model = JITTER_NONE;
+
+/**
+ * @brief Mean time between the starts of two stalls.
+ */
+double jitter_interval = 0.0;
+
+/**
+ * @brief Length of a stall.
+ */
+double jitter_length = 0.0;
+
+/**
+ * @brief Computes the time from a stall to the next one.
+ *
+ * @returns The time from the start of a stall to the start of the
+ * next one.
+ */
+static double thread_jitter_gap(void)
+{
+	double u; /* Uniform number in [0, 1). */
+
+	if (jitter_model == JITTER_PERIODIC)
+		return (jitter_interval);
+
+	/* Exponential time between stalls. */
+	u = rand()/(RAND_MAX + 1.0);
+
+	return (-jitter_interval*log(1.0 - u));
+}
+
+/**
+ * @brief Mean length of busy periods of background processes.
+ */
+double background_on = 0.0;
+
+/**
+ * @brief Mean length of idle periods of background processes.
+ */
+double background_off = 0.0;
+
+/**
+ * @brief Relative speed of a thread next to a busy background process.
+ */
+double background_share = 0.5;
+
+/**
+ * @brief Background load of a hardware thread.
+ */
+struct background
+{
+	bool traced;   /**< Given by a utilisation trace? */
+	double *time;  /**< Start of segments.            */
+	double *load;  /**< Load in segments.             */
+	int nsegments; /**< Number of segments.           */
 };
 
+/**
+ * @brief Background load of hardware threads.
+ */
+static struct background *background = NULL;
+
+/**
+ * @brief Number of hardware threads with background load.
+ */
+static int background_ncpus = 0;
+
+/**
+ * @brief Gets the background load of a hardware thread.
+ *
+ * @param cpu Target hardware thread.
+ *
+ * @returns The background load of the target hardware thread.
+ */
+static struct background *background_get(int cpu)
+{
+	/* Sanity check. */
+	assert(cpu >= 0);
+
+	if (cpu >= background_ncpus)
+	{
+		background = realloc(background, (cpu + 1)*sizeof(struct background));
+		assert(background != NULL);
+		memset(&background[background_ncpus], 0, (cpu + 1 - background_ncpus)*sizeof(struct background));
+		background_ncpus = cpu + 1;
+	}
+
+	return (&background[cpu]);
+}
+
+/**
+ * @brief Appends a segment to a background load.
+ *
+ * @param b    Target background load.
+ * @param time Start of the segment.
+ * @param load Load in the segment.
+ */
+static void background_append(struct background *b, double time, double load)
+{
+	b->time = realloc(b->time, (b->nsegments + 1)*sizeof(double));
+	b->load = realloc(b->load, (b->nsegments + 1)*sizeof(double));
+	assert((b->time != NULL) && (b->load != NULL));
+
+	b->time[b->nsegments] = time;
+	b->load[b->nsegments] = load;
+	b->nsegments++;
+}
+
+/**
+ * @brief Appends a segment to the utilisation trace of a hardware thread.
+ *
+ * @param cpu  Target hardware thread.
+ * @param time Start of the segment.
+ * @param load Fraction of time taken by other tenants in the segment.
+ */
+void background_set(int cpu, double time, double load)
+{
+	struct background *b; /* Background load. */
+
+	/* Sanity check. */
+	assert((load >= 0.0) && (load < 1.0));
+
+	b = background_get(cpu);
+	assert((b->nsegments == 0) || (time > b->time[b->nsegments - 1]));
+
+	b->traced = true;
+	background_append(b, time, load);
+}
+
+/**
+ * @brief Restarts background processes.
+ *
+ * @details Background processes follow a new random course in each
+ * loop instance. Utilisation traces are replayed.
+ */
+void background_reset(void)
+{
+	for (int i = 0; i < background_ncpus; i++)
+	{
+		if (!background[i].traced)
+			background[i].nsegments = 0;
+	}
+}
+
+/**
+ * @brief Returns the background load of a hardware thread.
+ *
+ * @details Hardware threads that have no utilisation trace run a
+ * background process, if any, that is alternately busy and idle for
+ * exponentially distributed periods of time. Its course is drawn as
+ * time goes by.
+ *
+ * @param cpu  Target hardware thread.
+ * @param seg  Next segment (input and output).
+ * @param now  Current time.
+ * @param next Time of the next load change (output).
+ *
+ * @returns The fraction of time taken by background load.
+ */
+static double background_load(int cpu, int *seg, double now, double *next)
+{
+	struct background *b; /* Background load. */
+
+	b = background_get(cpu);
+
+	/* Background process. */
+	if ((!b->traced) && (background_on > 0.0))
+	{
+		if (b->nsegments == 0)
+		{
+			bool busy = (rand()/(RAND_MAX + 1.0)) < background_on/(background_on + background_off);
+
+			background_append(b, 0.0, (busy) ? 1.0 - background_share : 0.0);
+		}
+
+		while (b->time[b->nsegments - 1] <= now)
+		{
+			bool busy = (b->load[b->nsegments - 1] > 0.0);
+			double u = rand()/(RAND_MAX + 1.0);
+			double length = -((busy) ? background_on : background_off)*log(1.0 - u);
+
+			background_append(b, b->time[b->nsegments - 1] + length, (busy) ? 0.0 : 1.0 - background_share);
+		}
+	}
+
+	while ((*seg < b->nsegments) && (b->time[*seg] <= now))
+		(*seg)++;
+	*next = (*seg < b->nsegments) ? b->time[*seg] : INFINITY;
+
+	return ((*seg > 0) ? b->load[*seg - 1] : 0.0);
+}
+
 /**
  * @brief Next available thread identification number.
  */
@@ -48,18 +396,40 @@ static int next_tid = 0;
  *
  * @returns A thread.
  */
-struct thread *thread_create(int capacity)
+struct thread *thread_create(double capacity)
 {
 	struct thread *t;
 
 	/* Sanity check. */
-	assert((capacity >= 1) && (capacity <= 100));
+	assert(capacity > 0.0);
 
 	t = smalloc(sizeof(struct thread));
 
 	t->tid = next_tid++;
-	t->wtotal = 0;
+	t->wtotal = 0.0;
+	t->wremote = 0.0;
 	t->capacity = capacity;
+	t->rate = 1.0/capacity;
+	t->socket = 0;
+	t->node = 0;
+	t->cache = 0;
+	t->type = 0;
+	t->offset = -1.0;
+	t->core = t->tid;
+	t->cpu = t->tid;
+	t->arrival = 0.0;
+	t->departure = INFINITY;
+	t->proxy = NULL;
+	t->record = NULL;
+	t->nrecorded = 0;
+	t->segtime = NULL;
+	t->segrate = NULL;
+	t->nsegments = 0;
+	t->seg = 0;
+	t->stall = 0.0;
+	t->nranges = 0;
+
+	thread_reset(t);
 
 	return (t);
 }
@@ -74,6 +444,10 @@ void thread_destroy(struct thread *t)
 	/* Sanity check. */
 	assert(t != NULL);
 
+	if (t->segrate != NULL)
+		free(t->segrate);
+	if (t->segtime != NULL)
+		free(t->segtime);
 	free(t);
 }
 
@@ -104,25 +478,203 @@ double thread_wtotal(const struct thread *t)
 	/* Sanity check. */
 	assert(t != NULL);
 
-	return (((double)t->wtotal)*t->capacity);
+	return (t->wtotal*t->capacity);
+}
+
+/**
+ * @brief Touches the data of a task in the cache of a thread.
+ *
+ * @details The cache holds ranges of contiguous tasks, in least
+ * recently used order. A task whose range or a neighbour of it is
+ * cached is a hit, and extends that range, which absorbs any other
+ * range it then reaches. Otherwise the task starts a new range. Least
+ * recently used tasks are evicted when the footprint of cached tasks
+ * exceeds the size of the cache.
+ *
+ * @param t Target thread.
+ * @param i Target task.
+ *
+ * @returns The relative cost of the task: one if its data was not
+ * cached, locality_reuse if the task itself was cached, from an earlier
+ * loop instance, and locality_warm if a neighbour of it was.
+ */
+static double thread_touch(struct thread *t, int i)
+{
+	int r;            /* Current range.            */
+	double cost;      /* Relative cost.            */
+	struct range tmp; /* Touched range.            */
+	int capacity;     /* Cache capacity, in tasks. */
+	int size;         /* Cached tasks.             */
+
+	for (r = 0; r < t->nranges; r++)
+	{
+		if ((t->lru[r].lo - 1 <= i) && (i <= t->lru[r].hi + 1))
+			break;
+	}
+
+	cost = 1.0;
+
+	/* Extend range. */
+	if (r < t->nranges)
+	{
+		tmp = t->lru[r];
+		cost = locality_warm;
+		if ((tmp.lo <= i) && (i <= tmp.hi))
+		{
+			cost = locality_reuse;
+			t->nreuses++;
+		}
+		t->nhits++;
+		if (tmp.lo > i)
+			tmp.lo = i;
+		if (tmp.hi < i)
+			tmp.hi = i;
+	}
+
+	/* New range, possibly replacing the least recently used one. */
+	else
+	{
+		tmp.lo = tmp.hi = i;
+		r = (t->nranges < LOCALITY_NRANGES) ? t->nranges++ : t->nranges - 1;
+	}
+
+	memmove(&t->lru[1], &t->lru[0], r*sizeof(struct range));
+	t->lru[0] = tmp;
+
+	/* Merge ranges that the touched one now reaches. */
+	for (r = 1; r < t->nranges; r++)
+	{
+		if ((t->lru[r].lo - 1 > t->lru[0].hi) || (t->lru[0].lo > t->lru[r].hi + 1))
+			continue;
+
+		if (t->lru[0].lo > t->lru[r].lo)
+			t->lru[0].lo = t->lru[r].lo;
+		if (t->lru[0].hi < t->lru[r].hi)
+			t->lru[0].hi = t->lru[r].hi;
+
+		t->nranges--;
+		memmove(&t->lru[r], &t->lru[r + 1], (t->nranges - r)*sizeof(struct range));
+		r--;
+	}
+
+	/* Evict least recently used tasks. */
+	capacity = locality_cache/locality_footprint;
+	if (capacity < 1)
+		capacity = 1;
+	size = 0;
+	for (r = 0; r < t->nranges; r++)
+	{
+		int len = t->lru[r].hi - t->lru[r].lo + 1;
+
+		if (size + len <= capacity)
+		{
+			size += len;
+			continue;
+		}
+
+		/* Keep the most recently touched end. */
+		if (size < capacity)
+		{
+			int n = capacity - size; /* Tasks kept. */
+
+			if ((r == 0) && (t->lru[r].lo == i))
+				t->lru[r].hi = i + n - 1;
+			else if (r == 0)
+			{
+				if (t->lru[r].lo < i - n + 1)
+					t->lru[r].lo = i - n + 1;
+				t->lru[r].hi = t->lru[r].lo + n - 1;
+			}
+			else
+				t->lru[r].lo = t->lru[r].hi - n + 1;
+			r++;
+		}
+
+		t->nranges = r;
+		break;
+	}
+
+	return (cost);
 }
 
 /**
- * @brief Assigns a workload to a thread.
+ * @brief Charges processing time to a thread.
+ *
+ * @details Processing time is kept exact and rounded once over all the
+ * work charged so far, rather than task by task, so that the time of a
+ * chunk, summed over its tasks, is rounded only once and small tasks
+ * on fast threads do not come for free.
  *
  * @param t     Target thread.
- * @param wsize Work size.
+ * @param wsize Work charged.
+ *
+ * @returns The processing time of the work charged.
+ */
+static int thread_time(struct thread *t, double wsize)
+{
+	double before = t->time; /* Time charged so far. */
+
+	t->time += t->capacity*wsize;
+
+	return ((int) (floor(t->time + 0.5) - floor(before + 0.5)));
+}
+
+/**
+ * @brief Assigns a task to a thread.
+ *
+ * @details The thread is charged the actual cost of the task, which
+ * may differ from the estimated cost seen by the scheduler, scaled by
+ * the relative cost of the task class on the core type of the thread.
+ * Tasks whose data is cached, because the thread has just run a
+ * neighbour task or ran the same task in an earlier loop instance,
+ * cost less. Tasks whose home NUMA node is not the one of the thread
+ * cost more. Tasks assigned to a thread that has a proxy are run by
+ * the proxy. Tasks assigned to a thread that keeps a record are only
+ * recorded, to be run elsewhere.
+ *
+ * @param t Target thread.
+ * @param w Target workload.
+ * @param i Target task.
  *
  * @returns Required processing time.
  */
-int thread_assign(struct thread *t, int wsize)
+int thread_assign(struct thread *t, const_workload_tt w, int i)
 {
+	double wsize;
+
 	/* Sanity check. */
 	assert(t != NULL);
 
+	if (t->proxy != NULL)
+		return (thread_assign(t->proxy, w, i));
+
+	/* Recorded. */
+	if (t->record != NULL)
+	{
+		t->record[t->nrecorded++] = i;
+		return (thread_time(t, workload_actual(w, i)));
+	}
+
+	wsize = workload_actual(w, i);
+	if (speed_matrix != NULL)
+		wsize *= speed_factor(workload_class(w, i), t->type);
+
+	/* Locality. */
+	t->ntasks++;
+	if ((locality_footprint > 0) && (locality_cache > 0))
+		wsize *= thread_touch(t, i);
+
+	/* Remote access. */
+	if ((numa_nnodes > 1) && (workload_home(w, i, numa_nnodes) != t->node))
+	{
+		wsize *= numa_remote;
+		t->wremote += wsize;
+	}
+
 	t->wtotal += wsize;
+	t->bytes += t->capacity*wsize*workload_intensity(w, i, bandwidth_intensity);
 
-	return (t->capacity*wsize);
+	return (thread_time(t, wsize));
 }
 
 /**
@@ -132,10 +684,616 @@ int thread_assign(struct thread *t, int wsize)
  *
  * @returns The capacity of the target thread.
  */
-int thread_capacity(const struct thread *t)
+double thread_capacity(const struct thread *t)
 {
 	/* Sanity check. */
 	assert(t != NULL);
 
 	return (t->capacity);
 }
+
+/**
+ * @brief Returns the processing rate of a thread.
+ *
+ * @details The processing rate is the reciprocal of the capacity, and
+ * it is precomputed so that strategies that weigh threads by their
+ * speed do not divide on every call.
+ *
+ * @param t target thread.
+ *
+ * @returns The processing rate of the target thread.
+ */
+double thread_rate(const struct thread *t)
+{
+	/* Sanity check. */
+	assert(t != NULL);
+
+	return (t->rate);
+}
+
+/**
+ * @brief Resets the workload assigned to a thread.
+ *
+ * @details The speed profile of the thread is rewound as well, and
+ * the first stall of the jitter model is drawn.
+ *
+ * @param t Target thread.
+ */
+void thread_reset(struct thread *t)
+{
+	/* Sanity check. */
+	assert(t != NULL);
+
+	t->wtotal = 0.0;
+	t->wremote = 0.0;
+	t->bytes = 0.0;
+	t->time = 0.0;
+	t->seg = 0;
+	t->bgseg = 0;
+	t->ntasks = 0;
+	t->nhits = 0;
+	t->nreuses = 0;
+	if (!locality_persist)
+		t->nranges = 0;
+
+	if (jitter_model == JITTER_NONE)
+		return;
+
+	/* Periodic stalls start at a random phase. */
+	t->stall = thread_jitter_gap();
+	if (jitter_model == JITTER_PERIODIC)
+		t->stall *= rand()/(RAND_MAX + 1.0);
+}
+
+/**
+ * @brief Returns the remote workload assigned to a thread.
+ *
+ * @param t Target thread.
+ *
+ * @returns The workload assigned to a thread that accessed remote
+ * memory.
+ */
+double thread_wremote(const struct thread *t)
+{
+	/* Sanity check. */
+	assert(t != NULL);
+
+	return (t->wremote*t->capacity);
+}
+
+/**
+ * @brief Places a thread in the machine topology.
+ *
+ * @param t      Target thread.
+ * @param socket Socket.
+ * @param node   NUMA node.
+ * @param cache  Shared cache.
+ */
+void thread_set_topology(struct thread *t, int socket, int node, int cache)
+{
+	/* Sanity check. */
+	assert(t != NULL);
+	assert(socket >= 0);
+	assert((node >= 0) && (node < numa_nnodes));
+	assert(cache >= 0);
+
+	t->socket = socket;
+	t->node = node;
+	t->cache = cache;
+}
+
+/**
+ * @brief Returns the socket of a thread.
+ *
+ * @param t Target thread.
+ *
+ * @returns The socket of the target thread.
+ */
+int thread_socket(const struct thread *t)
+{
+	/* Sanity check. */
+	assert(t != NULL);
+
+	return (t->socket);
+}
+
+/**
+ * @brief Returns the NUMA node of a thread.
+ *
+ * @param t Target thread.
+ *
+ * @returns The NUMA node of the target thread.
+ */
+int thread_node(const struct thread *t)
+{
+	/* Sanity check. */
+	assert(t != NULL);
+
+	return (t->node);
+}
+
+/**
+ * @brief Returns the shared cache of a thread.
+ *
+ * @param t Target thread.
+ *
+ * @returns The shared cache of the target thread.
+ */
+int thread_cache(const struct thread *t)
+{
+	/* Sanity check. */
+	assert(t != NULL);
+
+	return (t->cache);
+}
+
+/**
+ * @brief Sets the core type of a thread.
+ *
+ * @param t    Target thread.
+ * @param type Core type.
+ */
+void thread_set_type(struct thread *t, int type)
+{
+	/* Sanity check. */
+	assert(t != NULL);
+	assert((type >= 0) && (type < speed_ntypes));
+
+	t->type = type;
+}
+
+/**
+ * @brief Returns the core type of a thread.
+ *
+ * @param t Target thread.
+ *
+ * @returns The core type of the target thread.
+ */
+int thread_type(const struct thread *t)
+{
+	/* Sanity check. */
+	assert(t != NULL);
+
+	return (t->type);
+}
+
+/**
+ * @brief Appends a segment to the speed trace of a thread.
+ *
+ * @param t    Target thread.
+ * @param time Start of the segment.
+ * @param rate Relative speed in the segment.
+ */
+void thread_set_speed(struct thread *t, double time, double rate)
+{
+	/* Sanity check. */
+	assert(t != NULL);
+	assert(rate > 0.0);
+	assert((t->nsegments == 0) || (time > t->segtime[t->nsegments - 1]));
+
+	t->segtime = realloc(t->segtime, (t->nsegments + 1)*sizeof(double));
+	t->segrate = realloc(t->segrate, (t->nsegments + 1)*sizeof(double));
+	assert((t->segtime != NULL) && (t->segrate != NULL));
+
+	t->segtime[t->nsegments] = time;
+	t->segrate[t->nsegments] = rate;
+	t->nsegments++;
+}
+
+/**
+ * @brief Returns the speed of a thread.
+ *
+ * @details The thread runs at the rate of the current segment of its
+ * speed trace (nominal speed before the first one) and makes no
+ * progress while stalled by the jitter model. Background load on its
+ * hardware thread takes its share of the speed. Calls for a thread
+ * must come in increasing order of time.
+ *
+ * @param t    Target thread.
+ * @param now  Current time.
+ * @param next Time of the next speed change (output).
+ *
+ * @returns The relative speed of the thread at the current time.
+ */
+double thread_speed(struct thread *t, double now, double *next)
+{
+	double rate = 1.0; /* Current speed. */
+
+	/* Sanity check. */
+	assert(t != NULL);
+	assert(next != NULL);
+
+	*next = INFINITY;
+
+	/* Speed trace. */
+	while ((t->seg < t->nsegments) && (t->segtime[t->seg] <= now))
+		t->seg++;
+	if (t->seg > 0)
+		rate = t->segrate[t->seg - 1];
+	if (t->seg < t->nsegments)
+		*next = t->segtime[t->seg];
+
+	/* Jitter. */
+	if (jitter_model != JITTER_NONE)
+	{
+		while (t->stall + jitter_length <= now)
+			t->stall += thread_jitter_gap();
+
+		if (t->stall <= now)
+		{
+			rate = 0.0;
+			if (*next > t->stall + jitter_length)
+				*next = t->stall + jitter_length;
+		}
+		else if (*next > t->stall)
+			*next = t->stall;
+	}
+
+	/* Background load. */
+	if ((background != NULL) || (background_on > 0.0))
+	{
+		double change; /* Next load change. */
+
+		rate *= 1.0 - background_load(t->cpu, &t->bgseg, now, &change);
+		if (*next > change)
+			*next = change;
+	}
+
+	return (rate);
+}
+
+/**
+ * @brief Computes when a thread finishes some work.
+ *
+ * @details The speed profile of the thread is integrated from the
+ * start time on. Calls for a thread must come in increasing order of
+ * start time.
+ *
+ * @param t     Target thread.
+ * @param start Start time.
+ * @param work  Processing time at nominal speed.
+ *
+ * @returns The time at which the thread finishes the work.
+ */
+double thread_finish(struct thread *t, double start, double work)
+{
+	double now; /* Current time. */
+
+	/* Sanity check. */
+	assert(t != NULL);
+	assert(work >= 0.0);
+
+	now = start;
+	while (work > 0.0)
+	{
+		double next; /* Next speed change. */
+		double rate; /* Current speed.     */
+
+		rate = thread_speed(t, now, &next);
+
+		if ((rate > 0.0) && (now + work/rate <= next))
+			return (now + work/rate);
+
+		work -= rate*(next - now);
+		now = next;
+	}
+
+	return (now);
+}
+
+/**
+ * @brief Returns the number of tasks run by a thread.
+ *
+ * @param t Target thread.
+ *
+ * @returns The number of tasks run by the target thread.
+ */
+int thread_ntasks(const struct thread *t)
+{
+	/* Sanity check. */
+	assert(t != NULL);
+
+	return (t->ntasks);
+}
+
+/**
+ * @brief Returns the number of tasks run by a thread from its cache.
+ *
+ * @param t Target thread.
+ *
+ * @returns The number of tasks run by the target thread whose data
+ * was cached.
+ */
+int thread_nhits(const struct thread *t)
+{
+	/* Sanity check. */
+	assert(t != NULL);
+
+	return (t->nhits);
+}
+
+/**
+ * @brief Returns the number of tasks run again by a thread from its
+ * cache.
+ *
+ * @param t Target thread.
+ *
+ * @returns The number of tasks run by the target thread that were
+ * cached from an earlier loop instance.
+ */
+int thread_nreuses(const struct thread *t)
+{
+	/* Sanity check. */
+	assert(t != NULL);
+
+	return (t->nreuses);
+}
+
+/**
+ * @brief Migrates two threads, each to the core of the other.
+ *
+ * @details Threads take over the capacity, topology, core type and
+ * cache contents of their new cores.
+ *
+ * @param t1 First thread.
+ * @param t2 Second thread.
+ */
+void thread_migrate(struct thread *t1, struct thread *t2)
+{
+	struct thread tmp; /* Temporary thread. */
+
+	/* Sanity check. */
+	assert(t1 != NULL);
+	assert(t2 != NULL);
+
+	tmp = *t1;
+
+	t1->capacity = t2->capacity;
+	t1->rate = t2->rate;
+	t1->socket = t2->socket;
+	t1->node = t2->node;
+	t1->cache = t2->cache;
+	t1->type = t2->type;
+	t1->core = t2->core;
+	t1->cpu = t2->cpu;
+	memcpy(t1->lru, t2->lru, sizeof(t1->lru));
+	t1->nranges = t2->nranges;
+
+	t2->capacity = tmp.capacity;
+	t2->rate = tmp.rate;
+	t2->socket = tmp.socket;
+	t2->node = tmp.node;
+	t2->cache = tmp.cache;
+	t2->type = tmp.type;
+	t2->core = tmp.core;
+	t2->cpu = tmp.cpu;
+	memcpy(t2->lru, tmp.lru, sizeof(t2->lru));
+	t2->nranges = tmp.nranges;
+}
+
+/**
+ * @brief Returns the memory traffic of the workload assigned to a thread.
+ *
+ * @param t Target thread.
+ *
+ * @returns The number of bytes moved by the workload assigned to the
+ * target thread.
+ */
+double thread_bytes(const struct thread *t)
+{
+	/* Sanity check. */
+	assert(t != NULL);
+
+	return (t->bytes);
+}
+
+/**
+ * @brief Sets the start offset of a thread.
+ *
+ * @param t      Target thread.
+ * @param offset Start offset (negative for none).
+ */
+void thread_set_offset(struct thread *t, double offset)
+{
+	/* Sanity check. */
+	assert(t != NULL);
+
+	t->offset = offset;
+}
+
+/**
+ * @brief Returns the start offset of a thread.
+ *
+ * @param t Target thread.
+ *
+ * @returns The start offset of the target thread, or a negative number
+ * if none was given.
+ */
+double thread_offset(const struct thread *t)
+{
+	/* Sanity check. */
+	assert(t != NULL);
+
+	return (t->offset);
+}
+
+/**
+ * @brief Places a thread on a physical core.
+ *
+ * @details Threads on the same physical core are SMT siblings.
+ *
+ * @param t    Target thread.
+ * @param core Physical core.
+ */
+void thread_set_core(struct thread *t, int core)
+{
+	/* Sanity check. */
+	assert(t != NULL);
+	assert((core >= 0) && (core < smt_ncores));
+
+	t->core = core;
+}
+
+/**
+ * @brief Returns the physical core of a thread.
+ *
+ * @param t Target thread.
+ *
+ * @returns The physical core of the target thread.
+ */
+int thread_core(const struct thread *t)
+{
+	/* Sanity check. */
+	assert(t != NULL);
+
+	return (t->core);
+}
+
+/**
+ * @brief Binds a thread to a hardware thread.
+ *
+ * @details Threads that are bound to the same hardware thread take
+ * turns to run on it.
+ *
+ * @param t   Target thread.
+ * @param cpu Hardware thread.
+ */
+void thread_set_cpu(struct thread *t, int cpu)
+{
+	/* Sanity check. */
+	assert(t != NULL);
+	assert(cpu >= 0);
+
+	t->cpu = cpu;
+}
+
+/**
+ * @brief Returns the hardware thread of a thread.
+ *
+ * @param t Target thread.
+ *
+ * @returns The hardware thread of the target thread.
+ */
+int thread_cpu(const struct thread *t)
+{
+	/* Sanity check. */
+	assert(t != NULL);
+
+	return (t->cpu);
+}
+
+/**
+ * @brief Sets the time window in which a thread takes part in a loop.
+ *
+ * @param t         Target thread.
+ * @param arrival   Time of arrival.
+ * @param departure Time of departure.
+ */
+void thread_set_window(struct thread *t, double arrival, double departure)
+{
+	/* Sanity check. */
+	assert(t != NULL);
+	assert((arrival >= 0.0) && (arrival < departure));
+
+	t->arrival = arrival;
+	t->departure = departure;
+}
+
+/**
+ * @brief Returns the time at which a thread joins a loop.
+ *
+ * @param t Target thread.
+ *
+ * @returns The time of arrival of the target thread.
+ */
+double thread_arrival(const struct thread *t)
+{
+	/* Sanity check. */
+	assert(t != NULL);
+
+	return (t->arrival);
+}
+
+/**
+ * @brief Returns the time at which a thread leaves a loop.
+ *
+ * @param t Target thread.
+ *
+ * @returns The time of departure of the target thread.
+ */
+double thread_departure(const struct thread *t)
+{
+	/* Sanity check. */
+	assert(t != NULL);
+
+	return (t->departure);
+}
+
+/**
+ * @brief Sets the thread that runs the tasks assigned to a thread.
+ *
+ * @param t     Target thread.
+ * @param proxy Proxy thread. NULL means the thread itself.
+ */
+void thread_set_proxy(struct thread *t, struct thread *proxy)
+{
+	/* Sanity check. */
+	assert(t != NULL);
+	assert(proxy != t);
+
+	t->proxy = proxy;
+}
+
+/**
+ * @brief Makes a thread record the tasks assigned to it.
+ *
+ * @details Recorded tasks are not run by the thread. The record
+ * starts empty.
+ *
+ * @param t     Target thread.
+ * @param tasks Record of tasks. NULL means that tasks are run.
+ */
+void thread_set_record(struct thread *t, int *tasks)
+{
+	/* Sanity check. */
+	assert(t != NULL);
+
+	t->record = tasks;
+	t->nrecorded = 0;
+}
+
+/**
+ * @brief Returns the number of tasks recorded by a thread.
+ *
+ * @param t Target thread.
+ *
+ * @returns The number of tasks recorded by the target thread.
+ */
+int thread_nrecorded(const struct thread *t)
+{
+	/* Sanity check. */
+	assert(t != NULL);
+
+	return (t->nrecorded);
+}
+
+/**
+ * @brief Charges a thread with workload run on behalf of another one.
+ *
+ * @details Amounts are in units of work, before scaling by capacity.
+ * Negative amounts discharge the thread.
+ *
+ * @param t       Target thread.
+ * @param wtotal  Workload.
+ * @param wremote Remote workload.
+ * @param bytes   Memory traffic.
+ */
+void thread_charge(struct thread *t, double wtotal, double wremote, double bytes)
+{
+	/* Sanity check. */
+	assert(t != NULL);
+
+	t->wtotal += wtotal;
+	t->wremote += wremote;
+	t->bytes += t->capacity*bytes;
+}
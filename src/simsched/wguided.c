@@ -0,0 +1,173 @@
+/*
+ * Copyright(C) 2017 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ * 
+ * This file is part of Scheduler.
+ *
+ * Scheduler is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ * 
+ * Scheduler is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Scheduler; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include <mylib/util.h>
+#include <mylib/dqueue.h>
+#include <mylib/queue.h>
+
+#include <scheduler.h>
+
+/**
+ * @brief Workload-aware guided scheduler data.
+ */
+static struct
+{
+	int i0;                     /**< Last iteration scheduled. */
+	int *wsum;                  /**< Cummulative workload.     */
+	const_workload_tt workload; /**< Workload.                 */
+	array_tt threads;           /**< Threads.                  */
+	int chunksize;              /**< Chunksize.                */
+} scheddata = { 0, NULL, NULL, NULL, 1 };
+
+/**
+ * @brief Initializes the workload-aware guided scheduler.
+ * 
+ * @param workload  Target workload.
+ * @param threads   Target threads.
+ * @param chunksize Chunk size.
+ *
+ * @returns The number of tasks planned.
+ */
+int scheduler_wguided_init(const_workload_tt workload, array_tt threads, int chunksize)
+{
+	/* Sanity check. */
+	assert(workload != NULL);
+	assert(threads != NULL);
+	assert(chunksize > 0);
+
+	/* Already initialized, so rewind. */
+	if (scheddata.wsum != NULL)
+	{
+		scheddata.i0 = 0;
+		return (0);
+	}
+
+	/* Initialize scheduler data. */
+	scheddata.i0 = 0;
+	scheddata.wsum = workload_cummulative_sum(workload);
+	scheddata.workload = workload;
+	scheddata.threads = threads;
+	scheddata.chunksize = chunksize;
+
+	return (0);
+}
+
+/**
+ * @brief Finalizes the workload-aware guided scheduler.
+ */
+void scheduler_wguided_end(void)
+{
+	free(scheddata.wsum);
+	scheddata.wsum = NULL;
+}
+
+/**
+ * @brief Searches for the end of a chunk.
+ *
+ * @param i0     First iteration of the chunk.
+ * @param weight Target chunk weight.
+ *
+ * @returns The first iteration after the shortest chunk that starts at
+ * i0 and carries at least the target weight.
+ */
+static int scheduler_wguided_search(int i0, double weight)
+{
+	int lo, hi; /* Search range. */
+
+	lo = i0 + 1;
+	hi = workload_ntasks(scheddata.workload);
+
+	/* Binary search. */
+	while (lo < hi)
+	{
+		int mid = lo + (hi - lo)/2;
+
+		if (scheddata.wsum[mid] - scheddata.wsum[i0] < weight)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return (lo);
+}
+
+/**
+ * @brief Workload-aware guided scheduler.
+ * 
+ * @param running Target queue of running threads.
+ * @param t       Target thread
+ * 
+ * @returns Number scheduled tasks,
+ */
+int scheduler_wguided_sched(dqueue_tt running, thread_tt t)
+{
+	int chunksize; /* Number of tasks scheduled. */
+	int wsize;     /* Size of assigned work.     */
+	int ntasks;    /* Number of tasks.           */
+	int nthreads;  /* Number of hteads.          */
+	double weight; /* Target chunk weight.       */
+
+	ntasks = workload_ntasks(scheddata.workload);
+
+	/* Done. */
+	if (scheddata.i0 == ntasks)
+		return (0);
+
+	nchunks++;
+
+	nthreads = array_size(scheddata.threads);
+
+	/* Compute chunksize. */
+	weight = (scheddata.wsum[ntasks] - scheddata.wsum[scheddata.i0])/(2.0*nthreads);
+	chunksize = scheduler_wguided_search(scheddata.i0, weight) - scheddata.i0;
+	if (chunksize < scheddata.chunksize)
+		chunksize = scheddata.chunksize;
+	if (chunksize > ntasks - scheddata.i0)
+		chunksize = ntasks - scheddata.i0;
+
+	/* Schedule iterations. */
+	wsize = 0;
+	for (int i = scheddata.i0; i < (scheddata.i0 + chunksize); i++)
+		wsize += thread_assign(t, scheddata.workload, i);
+
+	/* Update schedule data. */
+	scheddata.i0 += chunksize;	
+	
+	dqueue_insert(running, t, wsize);
+
+	return (chunksize);
+}
+
+/**
+ * @brief Workload-aware guided scheduler.
+ */
+static struct scheduler _sched_wguided = {
+	false,
+	scheduler_wguided_init,
+	scheduler_wguided_sched,
+	scheduler_wguided_end
+};
+
+const struct scheduler *sched_wguided = &_sched_wguided;